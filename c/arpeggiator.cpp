@@ -0,0 +1,311 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Arpeggiator steps, held note order and the step alarm, see
+// arpeggiator.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "xil_printf.h"
+#include "xil_exception.h"
+#include "arpeggiator.hpp"
+#include "midi_clock.hpp"
+#include "midi_parser.hpp"
+#include "functions.hpp"
+#include "telemetry.hpp"
+#include "recorder.hpp"
+#include "zones.hpp"
+
+arpeggiator arp;
+
+bool arpeggiator::enabled() {
+    return mode != ARP_OFF;
+}
+
+// A note on while the arpeggiator is on, kept in the order played
+// with the midi channel it came in on so it plays through its zones
+void arpeggiator::hold(unsigned char note, unsigned char channel, unsigned char velocity) {
+    for (unsigned int i=0; i<count; ++i) {
+        if (held[i] == note) {
+            held_channel[i] = channel;
+            held_velocity[i] = velocity;
+            return;
+        }
+    }
+    if (count < ARP_NOTES) {
+        held[count] = note;
+        held_channel[count] = channel;
+        held_velocity[count] = velocity;
+        count += 1;
+    }
+    return;
+}
+
+// A note off, false if the note was not held here
+bool arpeggiator::release(unsigned char note) {
+    for (unsigned int i=0; i<count; ++i) {
+        if (held[i] == note) {
+            for (unsigned int j=i; j+1<count; ++j) {
+                held[j] = held[j+1];
+                held_channel[j] = held_channel[j+1];
+                held_velocity[j] = held_velocity[j+1];
+            }
+            count -= 1;
+            if (position > i) {
+                position -= 1;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Switching off drops the held notes, they were never played
+void arpeggiator::set_mode(unsigned char x) {
+    unsigned char was = mode;
+
+    mode = (x > ARP_PLAYED) ? ARP_OFF : x;
+    if (mode == ARP_OFF) {
+        silence();
+        count = 0;
+        armed = false;
+    }
+    else if (was == ARP_OFF) {
+        position = 0;
+        last = ARP_NONE;
+        rising = true;
+        align();
+        arm();
+    }
+    return;
+}
+
+// Clocks per step, 6 for sixteenths up to 96 for whole notes
+void arpeggiator::set_rate(unsigned char x) {
+    rate = (x < 1) ? 1 : x;
+    return;
+}
+
+// Time the steps with a one shot alarm at an absolute global timer
+// time. Without one, service() polls for the due steps
+void arpeggiator::set_alarm(void (*x)(XTime)) {
+    alarm = x;
+    return;
+}
+
+// First step on the first clock not yet due that is a whole step
+// from the start of the song
+void arpeggiator::align() {
+    unsigned int clock = tempo.next_clock();
+    step_clock = ((clock + rate - 1) / rate) * rate;
+    return;
+}
+
+// Set the alarm for the next note off or step, whichever is first
+void arpeggiator::arm() {
+    if (mode == ARP_OFF || !tempo.is_running()) {
+        armed = false;
+        return;
+    }
+
+    wake = tempo.due(step_clock);
+    if (sounding != ARP_NONE && (long long) (off_due - wake) < 0) {
+        wake = off_due;
+    }
+    armed = true;
+    if (alarm != NULL) {
+        alarm(wake);
+    }
+    return;
+}
+
+// End the note that is sounding
+void arpeggiator::silence() {
+    if (sounding != ARP_NONE) {
+        zones.note_off(sounding, sounding_channel);
+        sounding = ARP_NONE;
+    }
+    return;
+}
+
+// Transport start, the first step is on clock 0
+void arpeggiator::start() {
+    silence();
+    step_clock = 0;
+    position = 0;
+    last = ARP_NONE;
+    rising = true;
+    arm();
+    return;
+}
+
+// Transport continue, the pattern carries on from the next step
+void arpeggiator::resume() {
+    silence();
+    align();
+    arm();
+    return;
+}
+
+void arpeggiator::stop() {
+    silence();
+    armed = false;
+    return;
+}
+
+// A new clock moved the prediction, set the alarm again
+void arpeggiator::retime() {
+    if (mode != ARP_OFF) {
+        arm();
+    }
+    return;
+}
+
+// Held note with the lowest pitch over x, count if none
+unsigned int arpeggiator::above(int x) {
+    unsigned int best = count;
+
+    for (unsigned int i=0; i<count; ++i) {
+        if (held[i] > x && (best == count || held[i] < held[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Held note with the highest pitch under x, count if none
+unsigned int arpeggiator::below(int x) {
+    unsigned int best = count;
+
+    for (unsigned int i=0; i<count; ++i) {
+        if (held[i] < x && (best == count || held[i] > held[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Next held note for the mode, count if nothing is held
+unsigned int arpeggiator::pick() {
+    int up_from = (last == ARP_NONE) ? -1 : last;
+    int down_from = (last == ARP_NONE) ? 128 : last;
+    unsigned int v = count;
+
+    if (count == 0) {
+        return count;
+    }
+
+    switch (mode) {
+        case ARP_UP :
+            v = above(up_from);
+            if (v == count) {
+                v = above(-1);
+            }
+            break;
+
+        case ARP_DOWN :
+            v = below(down_from);
+            if (v == count) {
+                v = below(128);
+            }
+            break;
+
+        case ARP_UP_DOWN :
+            v = rising ? above(up_from) : below(down_from);
+            if (v == count) {
+                rising = !rising;
+                v = rising ? above(up_from) : below(down_from);
+            }
+            if (v == count) {
+                v = above(-1);
+            }
+            break;
+
+        default :
+            if (position >= count) {
+                position = 0;
+            }
+            v = position;
+            position += 1;
+            break;
+    }
+
+    last = held[v];
+    return v;
+}
+
+// Called from the timer interrupt. Ends the note whose gate is up and
+// plays the step that is due, a step that is a whole step late is
+// skipped rather than played out of time. Steps that play are counted
+// with how late they were against the tracked clock
+void arpeggiator::tick() {
+    XTime now;
+    XTime due;
+    XTime length;
+    u32 late;
+    unsigned int v;
+
+    XTime_GetTime(&now);
+    armed = false;
+
+    if (mode == ARP_OFF || !tempo.is_running()) {
+        silence();
+        return;
+    }
+
+    if (sounding != ARP_NONE && (long long) (now - off_due) >= 0) {
+        silence();
+    }
+
+    due = tempo.due(step_clock);
+    if ((long long) (now - due) >= 0) {
+        length = tempo.due(step_clock + rate) - due;
+        late = (u32) (now - due);
+
+        if (late < length) {
+            silence();
+            v = pick();
+            if (v != count) {
+                if (zones.note_on(held[v], held_channel[v], held_velocity[v])) {
+                    sounding = held[v];
+                    sounding_channel = held_channel[v];
+                    off_due = due + length/2;
+                }
+
+                telemetry.count.arp_steps += 1;
+                telemetry.count.arp_jitter_sum += late;
+                if (late > telemetry.count.arp_jitter_max) {
+                    telemetry.count.arp_jitter_max = late;
+                }
+                recorder.log(RECORDER_ARP, held[v], late);
+            }
+        }
+
+        step_clock += rate;
+        while ((long long) (now - tempo.due(step_clock)) >= 0) {
+            step_clock += rate;
+        }
+    }
+    arm();
+    return;
+}
+
+// Called from the main loop. Only hosted builds have no alarm,
+// the target's timer interrupt calls tick() itself
+void arpeggiator::service() {
+    XTime now;
+
+    if (alarm != NULL || !armed) {
+        return;
+    }
+
+    XTime_GetTime(&now);
+    if ((long long) (now - wake) >= 0) {
+        Xil_ExceptionDisable();
+        tick();
+        Xil_ExceptionEnable();
+    }
+    return;
+}
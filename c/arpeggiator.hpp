@@ -0,0 +1,99 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Arpeggiator. While it is on, note ons and offs from the parsers
+// only change the set of held notes, and the arpeggiator plays them one step
+// at a time straight into the voice list. Steps fall on the clock numbers of
+// the midi clock tracker, every ARP_RATE clocks, so they follow an external
+// sequencer or drum machine and keep the internal tempo when there is none.
+// Each note is held for half a step.
+//
+// Steps are timed by a one shot alarm at the due time of the next event,
+// the A9 private timer on target, and set again whenever a new clock moves
+// the prediction. The lateness of every step against its due time on the
+// tracked clock is counted into the telemetry as the step jitter.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_ARPEGGIATOR_HPP
+#define MYLIB_ARPEGGIATOR_HPP
+
+#include <stdio.h>
+#include "xil_types.h"
+#include "xtime_l.h"
+#include "constants.hpp"
+
+    // Modes, sent as the value of the ARPEGGIATOR control change
+    #define ARP_OFF         0
+    #define ARP_UP          1
+    #define ARP_DOWN        2
+    #define ARP_UP_DOWN     3
+    #define ARP_PLAYED      4
+
+    #define ARP_NOTES       16
+    #define ARP_NONE        255
+
+    // Clocks per step at power up, sixteenth notes
+    #define ARP_RATE_INIT   6
+
+class arpeggiator {
+    unsigned char held[ARP_NOTES];
+    unsigned char held_channel[ARP_NOTES];
+    unsigned char held_velocity[ARP_NOTES];
+    unsigned int count;
+    unsigned char mode;
+    unsigned int rate;
+    unsigned int step_clock;
+    unsigned int position;
+    unsigned char last;
+    bool rising;
+    unsigned char sounding;
+    unsigned char sounding_channel;
+    XTime off_due;
+    XTime wake;
+    bool armed;
+    void (*alarm)(XTime);
+
+    void align();
+    void arm();
+    void silence();
+    unsigned int above(int);
+    unsigned int below(int);
+    unsigned int pick();
+
+    public:
+
+        arpeggiator() {
+            count = 0;
+            mode = ARP_OFF;
+            rate = ARP_RATE_INIT;
+            step_clock = 0;
+            position = 0;
+            last = ARP_NONE;
+            rising = true;
+            sounding = ARP_NONE;
+            sounding_channel = 0;
+            off_due = 0;
+            wake = 0;
+            armed = false;
+            alarm = NULL;
+        }
+
+        bool enabled();
+        void hold(unsigned char, unsigned char, unsigned char);
+        bool release(unsigned char);
+        void set_mode(unsigned char);
+        void set_rate(unsigned char);
+        void set_alarm(void (*)(XTime));
+        void start();
+        void resume();
+        void stop();
+        void retime();
+        void tick();
+        void service();
+};
+
+    extern arpeggiator arp;
+
+#endif
@@ -0,0 +1,140 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Posting and applying the latest-wins controller slots, see
+// coalesce.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "xil_printf.h"
+#include "xil_io.h"
+#include "coalesce.hpp"
+#include "functions.hpp"
+
+// Store the latest pitch bend of a channel, counting the
+// previous value as merged if it was never applied
+void coalescer::post_bend(unsigned char channel, unsigned int x) {
+    unsigned int bit = 1 << (channel & 0x0F);
+
+    if (bend_pending & bit) {
+        merged += 1;
+    }
+    bend[channel & 0x0F] = x;
+    bend_pending |= bit;
+    pending |= SLOT_BEND;
+    return;
+}
+
+// Store the latest volume of a channel
+void coalescer::post_volume(unsigned char channel, unsigned char x) {
+    unsigned int bit = 1 << (channel & 0x0F);
+
+    if (volume_pending & bit) {
+        merged += 1;
+    }
+    volume[channel & 0x0F] = x;
+    volume_last = channel & 0x0F;
+    volume_pending |= bit;
+    pending |= SLOT_VOLUME;
+    return;
+}
+
+// Store the latest channel aftertouch of a channel
+void coalescer::post_pressure(unsigned char channel, unsigned char x) {
+    unsigned int bit = 1 << (channel & 0x0F);
+
+    if (pressure_pending & bit) {
+        merged += 1;
+    }
+    pressure[channel & 0x0F] = x;
+    pressure_last = channel & 0x0F;
+    pressure_pending |= bit;
+    pending |= SLOT_PRESSURE;
+    return;
+}
+
+// Store the latest polyphonic aftertouch for a single note of a channel
+void coalescer::post_poly_pressure(unsigned char channel, unsigned char note, unsigned char x) {
+    unsigned int *slots = poly_pending[channel & 0x0F];
+    unsigned int word = (note & 0x7F) >> 5;
+    unsigned int bit = 1 << (note & 0x1F);
+
+    if (slots[word] & bit) {
+        merged += 1;
+    }
+    poly_pressure[channel & 0x0F][note & 0x7F] = x;
+    slots[word] |= bit;
+    pending |= SLOT_POLY;
+    return;
+}
+
+bool coalescer::is_pending() {
+    return pending != 0;
+}
+
+// Write every pending slot to the synthesizer. Must be called with
+// the midi interrupt masked since the parser posts into the same slots
+void coalescer::apply(linked_list &channels) {
+    unsigned int slots = pending;
+    unsigned int ctrl;
+    unsigned int mod_amp;
+    unsigned int bits;
+    unsigned char channel;
+    unsigned char note;
+
+    pending = 0;
+
+    if (slots & SLOT_BEND) {
+        bits = bend_pending;
+        bend_pending = 0;
+        while (bits != 0) {
+            channel = __builtin_ctz(bits);
+            bits &= bits - 1;
+            channels.bend_pitch(channel, bend[channel]);
+        }
+    }
+
+    // Volume and channel aftertouch share the control register,
+    // so both are folded into a single read-modify-write. Other
+    // channels waiting on it are overwritten and count as merged
+    if (slots & (SLOT_VOLUME | SLOT_PRESSURE)) {
+        ctrl = Xil_In32(CTRL_REG_ADDR);
+
+        if (slots & SLOT_VOLUME) {
+            merged += __builtin_popcount(volume_pending) - 1;
+            volume_pending = 0;
+            ctrl = (ctrl & VOLUME_RST) | (volume[volume_last] << 15);
+        }
+
+        if (slots & SLOT_PRESSURE) {
+            merged += __builtin_popcount(pressure_pending) - 1;
+            pressure_pending = 0;
+            mod_amp = MOD_AMP_INIT + (((127 - MOD_AMP_INIT) * pressure[pressure_last]) >> 7);
+            ctrl = (ctrl & MOD_AMP_RST) | (mod_amp << 22);
+        }
+
+        synth_broadcast(CTRL_REG_ADDR, ctrl);
+    }
+
+    if (slots & SLOT_POLY) {
+        for (unsigned int c=0; c<NUM_MIDI_CHANNELS; ++c) {
+            for (unsigned int i=0; i<NUM_MIDI_NOTES/32; ++i) {
+                bits = poly_pending[c][i];
+                poly_pending[c][i] = 0;
+                while (bits != 0) {
+                    note = (i << 5) + __builtin_ctz(bits);
+                    bits &= bits - 1;
+                    channels.apply_pressure(c, note, poly_pressure[c][note]);
+                }
+            }
+        }
+    }
+    return;
+}
+
+// Number of controller messages overwritten before they were applied
+unsigned int coalescer::merged_count() {
+    return merged;
+}
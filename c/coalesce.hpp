@@ -0,0 +1,79 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Holds the latest value of every high rate controller (pitch bend,
+// volume, channel and polyphonic aftertouch) between the midi parser and the
+// voice engine. Each new message overwrites its slot, and the pending slots are
+// written to the synthesizer once per control tick. Slots are kept per midi
+// channel, and poly aftertouch per channel and note, so a message only merges
+// with an older one from the same channel. Volume and channel aftertouch drive
+// the one control register every voice shares, the channel posted last wins it.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_COALESCE_HPP
+#define MYLIB_COALESCE_HPP
+
+#include <stdio.h>
+#include "constants.hpp"
+#include "linked_list.hpp"
+
+    // Slots for the channel wide controllers
+    #define SLOT_BEND       0x00000001
+    #define SLOT_VOLUME     0x00000002
+    #define SLOT_PRESSURE   0x00000004
+    #define SLOT_POLY       0x00000008
+
+    #define NUM_MIDI_NOTES  128
+
+class coalescer {
+    volatile unsigned int pending;
+    unsigned int bend_pending;
+    unsigned int volume_pending;
+    unsigned int pressure_pending;
+    unsigned int poly_pending[NUM_MIDI_CHANNELS][NUM_MIDI_NOTES/32];
+    unsigned int bend[NUM_MIDI_CHANNELS];
+    unsigned char volume[NUM_MIDI_CHANNELS];
+    unsigned char pressure[NUM_MIDI_CHANNELS];
+    unsigned char volume_last;
+    unsigned char pressure_last;
+    unsigned char poly_pressure[NUM_MIDI_CHANNELS][NUM_MIDI_NOTES];
+    unsigned int merged;
+
+    public:
+
+        coalescer() {
+            pending = 0;
+            bend_pending = 0;
+            volume_pending = 0;
+            pressure_pending = 0;
+            volume_last = 0;
+            pressure_last = 0;
+            merged = 0;
+
+            for (unsigned int c=0; c<NUM_MIDI_CHANNELS; ++c) {
+                bend[c] = 0;
+                volume[c] = 0;
+                pressure[c] = 0;
+
+                for (unsigned int i=0; i<NUM_MIDI_NOTES/32; ++i) {
+                    poly_pending[c][i] = 0;
+                }
+
+                for (unsigned int i=0; i<NUM_MIDI_NOTES; ++i) {
+                    poly_pressure[c][i] = 0;
+                }
+            }
+        }
+
+        void post_bend(unsigned char, unsigned int);
+        void post_volume(unsigned char, unsigned char);
+        void post_pressure(unsigned char, unsigned char);
+        void post_poly_pressure(unsigned char, unsigned char, unsigned char);
+        bool is_pending();
+        void apply(linked_list &);
+        unsigned int merged_count();
+};
+
+#endif
@@ -9,8 +9,45 @@
 #ifndef MYLIB_CONSTANTS_H
 #define MYLIB_CONSTANTS_H
 
+#include "xparameters.h"
+#include "fixed_point.hpp"
 
-    //Register Base Address
+    //Unison detune ratios are 2.30 fixed point
+    #define DETUNE_UNITY    0x40000000
+    #define UNISON_MAX      8
+
+    //Each fm_synth_wrapper is a bank of NUM_CHANNELS voices. A second
+    //instance in the block design is picked up from xparameters.h
+    #ifdef XPAR_FM_SYNTH_WRAPPER_1_BASEADDR
+        #define NUM_BANKS   2
+    #else
+        #define NUM_BANKS   1
+    #endif
+
+    static const unsigned int BANK_BASE_ADDR[NUM_BANKS] = {
+        XPAR_FM_SYNTH_WRAPPER_0_BASEADDR,
+    #if NUM_BANKS > 1
+        XPAR_FM_SYNTH_WRAPPER_1_BASEADDR,
+    #endif
+    };
+
+    //Voice registers of a channel within a bank
+    #define CAR_ADDR(bank, chan)    (BANK_BASE_ADDR[bank] + 4*(chan))
+    #define MOD_ADDR(bank, chan)    (CAR_ADDR(bank, chan) + (4*NUM_CHANNELS))
+    #define VEL_ADDR(bank, chan)    (MOD_ADDR(bank, chan) + (4*NUM_CHANNELS))
+    #define ENV_ADDR(bank, chan)    (BANK_BASE_ADDR[bank] + 4*(64 + (chan)))
+
+    //Envelope readback fields, the level is the signed 2.22 envelope of
+    //rc_filter_fsm and anything below ENV_INAUDIBLE (about -60 dB) is silent
+    #define ENV_LEVEL(x)        (((x) & 0x800000) ? 0 : ((x) & 0x7FFFFF))
+    #define ENV_STAGE(x)        (((x) >> 24) & 0x3)
+    #define ENV_STAGE_IDLE      0
+    #define ENV_STAGE_ATTACK    1
+    #define ENV_STAGE_RELEASE   2
+    #define ENV_INAUDIBLE       0x00001000
+
+    //Register Base Address of bank 0, the shared registers are
+    //read from here and written to every bank with synth_broadcast
     #define CAR_BASE_ADDR XPAR_FM_SYNTH_WRAPPER_0_BASEADDR
     #define MOD_BASE_ADDR   (CAR_BASE_ADDR + (4*NUM_CHANNELS))
     #define VEL_BASE_ADDR   (MOD_BASE_ADDR + (4*NUM_CHANNELS))
@@ -23,23 +60,53 @@
 
     //UART Base Address
     #define UART_ADDR XPAR_AXI_UART_WRAPPER_0_BASEADDR
+    #define UART_STATUS_ADDR    (UART_ADDR + 4)
+    #define UART_BAUD_ADDR      (UART_ADDR + 8)
+    #define UART_DATA_VALID     0x00000100
+
+    //Status register fields, the error counts are 8 bit and wrap
+    #define UART_FIFO_LEVEL(x)  ((x) & 0xFF)
+    #define UART_OVERRUNS(x)    (((x) >> 8) & 0xFF)
+
+    //Baud dividers are clock cycles per bit in 16.8 fixed point
+    #define UART_CLK_HZ         32653061
+    #define UART_BAUD_DIV(x)    ((unsigned int) ((((unsigned long long) UART_CLK_HZ << 8) + (x)/2) / (x)))
+    #define NUM_BAUD_RATES      4
 
     /*
     Basic structure for linked list, one is created for each channel in synthesizer. 
     Holds information regarding current state of channel
-         -chan_num          : channel number
+         -chan_num          : channel number within the bank
+         -bank              : fm_synth_wrapper instance holding the channel
          -note              : holds tuning word for carrier note
          -mod               : holds tuning word for modulator note
          -index             : index to select carrier note from array
          -awaiting_reset    : set to 1 after note off from midi and reset to zero by interrupt
          -available         : set to 1 if channel not in use
          -enable            : set to 1 if channel in use, set to 0 to begin note off decay
+        -velocity          : note on velocity, used as the base level for aftertouch
+        -group             : id shared by every channel started by the same note on
+        -detune            : unison detune ratio applied to the carrier and modulator
+        -age               : allocation order, the lowest age is stolen first
+        -key               : midi key that played the channel, 255 when free
+        -source            : midi channel the note on came in on
+        -zone              : keyboard zone the channel plays for
+        -patch             : modulator patch of the zone, 0xFF to follow the PATCH controller
     */
     struct node {
         unsigned int chan_num = 0;
+        unsigned int bank = 0;
         unsigned int note = 0;
         unsigned int mod = 0;
         unsigned char index = 255;
+        unsigned char velocity = 0;
+        unsigned char group = 0;
+        unsigned int detune = DETUNE_UNITY;
+        unsigned int age = 0;
+        unsigned char key = 255;
+        unsigned char source = 0;
+        unsigned char zone = 0;
+        unsigned char patch = 0xFF;
         int awaiting_reset = 0;
         bool available = true;
         bool enable = false;
@@ -48,12 +115,12 @@
 
     /*
     Structure to hold information regarding a specific channel. Used when traversing linked list
-        -rst_cnt        : hold current place in reset queue so each note is turned off in order
+        -rst_cnt        : last place in each bank's reset queue so each note is turned off in order
         -in_use         : boolean to determine if channel is in use
         -awaiting_rst   : set to 1 after note off from midi and reset to zero by interrupt
     */
     struct info {
-        int rst_cnt = 0;
+        int rst_cnt[NUM_BANKS] = {};
         bool in_use = false;
         int awaiting_rst = 0;
         node *index = NULL;
@@ -91,12 +158,27 @@
     #define PROGRAM_CHANGE          0xC0
     #define CHANNEL_AFTERTOUCH      0xD0
     #define PITCH_BEND              0xE0
+    #define NUM_MIDI_CHANNELS       16
+
+    #define SYSEX_START             0xF0
+    #define SYSEX_END               0xF7
+
+    // Real time bytes, these may land anywhere in the stream
+    #define MIDI_CLOCK              0xF8
+    #define MIDI_START              0xFA
+    #define MIDI_CONTINUE           0xFB
+    #define MIDI_STOP               0xFC
 
     #define PATCH                   0x07
     #define MOD_AMP                 0x0A
     #define RC_TAU                  0x0B
     #define VOLUME                  0x5B
     #define MODULATE                0x40
+    #define UNISON                  0x0C
+    #define LOOPER                  0x0D
+    #define BANKS                   0x0E
+    #define ARPEGGIATOR             0x0F
+    #define ARP_RATE                0x10
 
     // #define S_STATUS            0
     // #define S_NOTE_ON           1
@@ -117,6 +199,9 @@
     #define MASK_ON  0X80000000
     #define MASK_OFF 0X7FFFFFFF
 
+    #define NUM_TUNING_WORDS    144
+    #define NUM_PRESETS         16
+
     #define TAU_ADDR 128
 
     #define VELOCITY_INIT   0b01000000000000000011000000000000
@@ -134,13 +219,79 @@
     #define RC_TAU_INIT     0b00001000000000010000000000001111
     #define RC_ATTACK_INIT  0b00000000000000000000000000100001
     #define RC_DECAY_INIT   0b00000000000000000000000000000001
-    #define RC_RELEASE_INIT 0b00000000000000000000000000000001
+    // rc_filter_fsm releases at the release rate, the power up release
+    // matches the attack as it did when the release used the attack rate
+    #define RC_RELEASE_INIT 0b00000000000000000000000000100001
     #define MOD_TAU_INIT    0x00000638
 
+    #define MOD_AMP_INIT    16
+
+    /*
+    Fixed point formats of the register fields, as the hdl reads them
+        -env_level      : attack and decay levels in the velocity register
+        -rc_tau         : rc filter time constants
+        -mod_tau_word   : modulator envelope time constant
+        -detune_ratio   : unison detune ratio applied to the tuning words
+        -tuning_fmt     : phase increment, signed in phase_modulate.v
+        -midi_value     : 7 bit midi data byte as a fraction of full scale
+        -velocity_fmt   : note on velocity, full scale just under 2.0
+        -cents_fmt      : pitch in cents for the tuning tables, not a register field
+    */
+    typedef Fixed<2,14> env_level;
+    typedef Fixed<2,22> rc_tau;
+    typedef Fixed<4,28> mod_tau_word;
+    typedef Fixed<2,30> detune_ratio;
+    typedef Fixed<32,0> tuning_fmt;
+    typedef Fixed<1,7>  midi_value;
+    typedef Fixed<2,6>  velocity_fmt;
+    typedef Fixed<16,16> cents_fmt;
+
+    // Time constants reached by a full scale RC_TAU or MOD_AMP controller
+    constexpr rc_tau        RC_ATTACK_MAX   = rc_tau::from_real(1.0/4096);
+    constexpr rc_tau        RC_DECAY_MAX    = rc_tau::from_real(1.0/16384);
+    constexpr mod_tau_word  MOD_TAU_MAX     = mod_tau_word::from_real(1.0/65536);
+
     #define MOD_AMP_RST 0b11000000001111111111111111111111
     #define VOLUME_RST  0b11111111110000000111111111111111
     #define TAU_RST     0b11111111111111111000000000000000
 
+    /*
+    Snapshot of the synthesizer settings, used for presets and sysex transfers.
+    The layout is sent byte for byte (little endian) by the librarian
+        -ctrl       : control register, wave select, mod amplitude, volume
+        -attack     : rc attack tau register
+        -decay      : rc decay tau register
+        -release    : rc release tau register
+        -mod_tau    : modulation envelope tau register
+        -patch      : modulator patch, 60 places the modulator on the carrier
+        -unison     : number of channels allocated per note
+    */
+    struct synth_state {
+        unsigned int ctrl = CTRL_INIT;
+        unsigned int attack = RC_ATTACK_INIT;
+        unsigned int decay = RC_DECAY_INIT;
+        unsigned int release = RC_RELEASE_INIT;
+        unsigned int mod_tau = MOD_TAU_INIT;
+        unsigned char patch = 60;
+        unsigned char unison = 1;
+        unsigned char reserved[2] = {0, 0};
+    };
+
+    /*
+    Unison detune spread, one row per voice count. The voices of a
+    group are spread evenly across +/-10 cents and each entry is the
+    2.30 fixed point ratio 2^(cents/1200) applied to the tuning words
+    */
+    static const unsigned int UNISON_DETUNE[UNISON_MAX][UNISON_MAX] = {
+        {0x40000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},   //  +0.00
+        {0x3FA1A296, 0x405EE95B, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},   // -10.00 +10.00
+        {0x3FA1A296, 0x40000000, 0x405EE95B, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},   // -10.00  +0.00 +10.00
+        {0x3FA1A296, 0x3FE07C05, 0x401F9388, 0x405EE95B, 0x00000000, 0x00000000, 0x00000000, 0x00000000},   // -10.00  -3.33  +3.33 +10.00
+        {0x3FA1A296, 0x3FD0BFDA, 0x40000000, 0x402F6322, 0x405EE95B, 0x00000000, 0x00000000, 0x00000000},   // -10.00  -5.00  +0.00  +5.00 +10.00
+        {0x3FA1A296, 0x3FC750CF, 0x3FED1559, 0x4012F040, 0x4038E192, 0x405EE95B, 0x00000000, 0x00000000},   // -10.00  -6.00  -2.00  +2.00  +6.00 +10.00
+        {0x3FA1A296, 0x3FC1078F, 0x3FE07C05, 0x40000000, 0x401F9388, 0x403F36A3, 0x405EE95B, 0x00000000},   // -10.00  -6.67  -3.33  +0.00  +3.33  +6.67 +10.00
+        {0x3FA1A296, 0x3FBC8A79, 0x3FD77DBC, 0x3FF27C64, 0x400D8677, 0x40289BF8, 0x4043BCED, 0x405EE95B}};  // -10.00  -7.14  -4.29  -1.43  +1.43  +4.29  +7.14 +10.00
+
     /*
     These tuning words were calculated based on a MATLAB
     script and are a function of the sampling rate, 
@@ -297,7 +448,7 @@
     #define B11   0b00101111100101000110011100001111
 
     // Tuning word array
-    static const unsigned int TUNING_WORD[144] =   {C0,  CS0,  D0,  DS0,  E0,  F0,  FS0,  G0,  GS0,  A0,  AS0,  B0,
+    static const unsigned int TUNING_WORD[NUM_TUNING_WORDS] =   {C0,  CS0,  D0,  DS0,  E0,  F0,  FS0,  G0,  GS0,  A0,  AS0,  B0,
                                                     C1,  CS1,  D1,  DS1,  E1,  F1,  FS1,  G1,  GS1,  A1,  AS1,  B1,
                                                     C2,  CS2,  D2,  DS2,  E2,  F2,  FS2,  G2,  GS2,  A2,  AS2,  B2,
                                                     C3,  CS3,  D3,  DS3,  E3,  F3,  FS3,  G3,  GS3,  A3,  AS3,  B3,
@@ -0,0 +1,147 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Signed fixed point values with WI integer bits (sign included)
+// and WF fraction bits, resized the same way as fixed_point_mult.v and
+// fixed_point_adder.v:
+//
+//      -fraction   : extra bits are zero filled, missing bits are truncated
+//                    (rounds toward minus infinity)
+//      -integer    : extra bits are sign extended, missing bits are dropped
+//                    keeping the sign bit, ovf is set when the value changed
+//
+// Multiplying or adding two values gives the full precision result, the
+// widening format of the hdl defaults. Use fixed_mult and fixed_add to get
+// the output format of a specific hdl instance.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_FIXED_POINT_HPP
+#define MYLIB_FIXED_POINT_HPP
+
+    // Resize a full precision value with wf_in fraction bits
+    // to a wi_o.wf_o word, keeping the sign bit on overflow
+    constexpr long long fixed_resize(long long x, int wf_in, int wi_o, int wf_o, bool *ovf) {
+        unsigned long long top = 1ULL << (wi_o + wf_o - 1);
+        long long y = (wf_o >= wf_in) ? x * (1LL << (wf_o - wf_in)) : x >> (wf_in - wf_o);
+        long long out = (long long) (y < 0 ? ((unsigned long long) y & (top - 1)) - top
+                                           : ((unsigned long long) y & (top - 1)));
+
+        if (ovf != nullptr) {
+            *ovf = (out != y);
+        }
+        return out;
+    }
+
+    template <int WI, int WF>
+    class Fixed {
+        static_assert(WI >= 1 && WF >= 0 && WI + WF <= 64, "unsupported fixed point format");
+
+        long long raw;
+
+        public:
+
+            static constexpr int int_bits = WI;
+            static constexpr int frac_bits = WF;
+            static constexpr int width = WI + WF;
+
+            constexpr Fixed() : raw(0) {}
+
+            // Take the low width bits of a register word, as
+            // the hdl does when a wire is assigned to a port
+            static constexpr Fixed from_word(unsigned long long x) {
+                return from_raw((long long) (x << (64 - width)) >> (64 - width));
+            }
+
+            // Signed value already in this format
+            static constexpr Fixed from_raw(long long x) {
+                Fixed y;
+                y.raw = x;
+                return y;
+            }
+
+            static constexpr Fixed from_int(long long x, bool *ovf = nullptr) {
+                return from_raw(fixed_resize(x, 0, WI, WF, ovf));
+            }
+
+            // Compile time constants only, the firmware has no float at runtime
+            static constexpr Fixed from_real(double x) {
+                return from_raw(fixed_resize(real_floor(x * (double) (1ULL << WF)), WF, WI, WF, nullptr));
+            }
+
+            constexpr long long bits() const {
+                return raw;
+            }
+
+            // Two's complement image of the value, as written to a register
+            constexpr unsigned long long word() const {
+                return (unsigned long long) raw & (width == 64 ? ~0ULL : (1ULL << width) - 1);
+            }
+
+            // Integer part, rounded toward minus infinity
+            constexpr long long to_int() const {
+                return raw >> WF;
+            }
+
+            template <int WI_O, int WF_O>
+            constexpr Fixed<WI_O, WF_O> convert(bool *ovf = nullptr) const {
+                return Fixed<WI_O, WF_O>::from_raw(fixed_resize(raw, WF, WI_O, WF_O, ovf));
+            }
+
+            constexpr Fixed<WI+1, WF> operator-() const {
+                return Fixed<WI+1, WF>::from_raw(-raw);
+            }
+
+            constexpr bool operator==(const Fixed &x) const { return raw == x.raw; }
+            constexpr bool operator!=(const Fixed &x) const { return raw != x.raw; }
+            constexpr bool operator<(const Fixed &x) const  { return raw < x.raw; }
+
+        private:
+
+            static constexpr long long real_floor(double x) {
+                return ((double) (long long) x > x) ? (long long) x - 1 : (long long) x;
+            }
+    };
+
+    // Full precision product, fixed_point_mult.v with its default output format
+    template <int WI_1, int WF_1, int WI_2, int WF_2>
+    constexpr Fixed<WI_1+WI_2, WF_1+WF_2> operator*(Fixed<WI_1, WF_1> a, Fixed<WI_2, WF_2> b) {
+        static_assert(WI_1 + WF_1 + WI_2 + WF_2 <= 64, "product wider than 64 bits");
+        return Fixed<WI_1+WI_2, WF_1+WF_2>::from_raw(a.bits() * b.bits());
+    }
+
+    // Format of a full precision sum, one integer bit above the wider input
+    template <int WI_1, int WF_1, int WI_2, int WF_2>
+    struct fixed_sum {
+        typedef Fixed<(WI_1 > WI_2 ? WI_1 : WI_2) + 1, (WF_1 > WF_2 ? WF_1 : WF_2)> type;
+    };
+
+    // Full precision sum, fixed_point_adder.v with one extra integer bit
+    template <int WI_1, int WF_1, int WI_2, int WF_2>
+    constexpr typename fixed_sum<WI_1, WF_1, WI_2, WF_2>::type operator+(Fixed<WI_1, WF_1> a, Fixed<WI_2, WF_2> b) {
+        typedef typename fixed_sum<WI_1, WF_1, WI_2, WF_2>::type sum;
+        return sum::from_raw(a.template convert<sum::int_bits, sum::frac_bits>().bits()
+                           + b.template convert<sum::int_bits, sum::frac_bits>().bits());
+    }
+
+    template <int WI_1, int WF_1, int WI_2, int WF_2>
+    constexpr typename fixed_sum<WI_1, WF_1, WI_2, WF_2>::type operator-(Fixed<WI_1, WF_1> a, Fixed<WI_2, WF_2> b) {
+        typedef typename fixed_sum<WI_1, WF_1, WI_2, WF_2>::type sum;
+        return sum::from_raw(a.template convert<sum::int_bits, sum::frac_bits>().bits()
+                           - b.template convert<sum::int_bits, sum::frac_bits>().bits());
+    }
+
+    // A fixed_point_mult.v instance with its output format
+    template <int WI_O, int WF_O, int WI_1, int WF_1, int WI_2, int WF_2>
+    constexpr Fixed<WI_O, WF_O> fixed_mult(Fixed<WI_1, WF_1> a, Fixed<WI_2, WF_2> b, bool *ovf = nullptr) {
+        return (a * b).template convert<WI_O, WF_O>(ovf);
+    }
+
+    // A fixed_point_adder.v instance with its output format
+    template <int WI_O, int WF_O, int WI_1, int WF_1, int WI_2, int WF_2>
+    constexpr Fixed<WI_O, WF_O> fixed_add(Fixed<WI_1, WF_1> a, Fixed<WI_2, WF_2> b, bool *ovf = nullptr) {
+        return (a + b).template convert<WI_O, WF_O>(ovf);
+    }
+
+#endif
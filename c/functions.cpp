@@ -6,20 +6,120 @@
 // Description: 
 //////////////////////////////////////////////////////////////////////////////////
 
+#include <string.h>
 #include "functions.hpp"
 #include "xil_printf.h"
 #include "xil_io.h"
+#include "xil_exception.h"
 #include "constants.hpp"
+#include "midi_parser.hpp"
+#include "looper.hpp"
+#include "telemetry.hpp"
+#include "soft_link.hpp"
+#include "last_state.hpp"
+#include "zones.hpp"
+#include "arpeggiator.hpp"
 
+    // Words of the boot image, and the place of a bank 0 register in it
+    #define BOOT_IMAGE_WORDS    (NUM_CHANNELS + 5)
+    #define BOOT_WORD(addr)     (((addr) - VEL_BASE_ADDR)/4)
+
+    synth_state presets[NUM_PRESETS];
+
+    // Synthesizer state shared by every parser, main and the
+    // hosted loop both run on these
+    linked_list channels;
+    coalescer controls;
+    unsigned char patch = 60;
+    unsigned char mod_byte = 0;
+
+    // Parser for bytes arriving on the midi uart
+    midi_parser live_parser;
+
+    // Event recorder, replays through its own parser
+    midi_looper looper;
+
+    // Bulk transfers of presets, tuning and synth state
+    sysex_decoder sysex;
+
+    // Midi uart rates, standard midi first
+    static const unsigned int BAUD_RATE[NUM_BAUD_RATES] = {31250, 1000000, 2000000, 3000000};
+
+    // Write one of the shared registers, given by its bank 0 address,
+    // to every bank so the banks always hold the same settings
+    void synth_broadcast(unsigned int addr, unsigned int value) {
+        for (unsigned int bank=0; bank<NUM_BANKS; ++bank) {
+            synth_out32(addr - BANK_BASE_ADDR[0] + BANK_BASE_ADDR[bank], value);
+        }
+        return;
+    }
+
+    // Power up register image of a bank, the velocities then the shared
+    // registers, so it covers VEL_BASE_ADDR to MOD_TAU_ADDR without a gap
+    static const unsigned int BOOT_IMAGE[BOOT_IMAGE_WORDS] = {
+        VELOCITY_INIT, VELOCITY_INIT, VELOCITY_INIT, VELOCITY_INIT,
+        VELOCITY_INIT, VELOCITY_INIT, VELOCITY_INIT, VELOCITY_INIT,
+        VELOCITY_INIT, VELOCITY_INIT, VELOCITY_INIT, VELOCITY_INIT,
+        VELOCITY_INIT, VELOCITY_INIT, VELOCITY_INIT, VELOCITY_INIT,
+        CTRL_INIT, RC_ATTACK_INIT, RC_DECAY_INIT, RC_RELEASE_INIT, MOD_TAU_INIT
+    };
+    static_assert(BOOT_WORD(MOD_TAU_ADDR) == BOOT_IMAGE_WORDS-1, "the boot image must end on MOD_TAU_ADDR");
+
+    // The image to every bank as one run of ascending writes
+    static void synth_image(const unsigned int *image) {
+        for (unsigned int bank=0; bank<NUM_BANKS; ++bank) {
+            UINTPTR addr = VEL_BASE_ADDR - BANK_BASE_ADDR[0] + BANK_BASE_ADDR[bank];
+            for (unsigned int i=0; i<BOOT_IMAGE_WORDS; ++i) {
+                synth_out32(addr + 4*i, image[i]);
+            }
+        }
+        return;
+    }
+
+    // The last state from storage goes into the image before it is
+    // written, so the registers are set once. Called before the
+    // interrupts are on
     void synth_init(unsigned int ctrl_init) {
-        Xil_Out32(CTRL_REG_ADDR, ctrl_init);
-        Xil_Out32(RC_ATTACK_ADDR, RC_ATTACK_INIT);
-        Xil_Out32(RC_DECAY_ADDR, RC_DECAY_INIT);
-        Xil_Out32(RC_RELEASE_ADDR, RC_RELEASE_INIT);
-        Xil_Out32(MOD_TAU_ADDR, 0x00000638);
-        for (int i=0; i<NUM_CHANNELS; i=i+1) {
-            Xil_Out32(VEL_BASE_ADDR + 4*i, VELOCITY_INIT);
+        unsigned int image[BOOT_IMAGE_WORDS];
+        synth_state state;
+
+        recorder.init();
+        telemetry.init();
+        tuning_init();
+        zones.init();
+
+        memcpy(image, BOOT_IMAGE, sizeof(image));
+        image[BOOT_WORD(CTRL_REG_ADDR)] = ctrl_init;
+        if (last_state.restore(state)) {
+            image[BOOT_WORD(CTRL_REG_ADDR)] = state.ctrl;
+            image[BOOT_WORD(RC_ATTACK_ADDR)] = state.attack;
+            image[BOOT_WORD(RC_DECAY_ADDR)] = state.decay;
+            image[BOOT_WORD(RC_RELEASE_ADDR)] = state.release;
+            image[BOOT_WORD(MOD_TAU_ADDR)] = state.mod_tau;
+            patch = state.patch;
+            channels.set_unison(state.unison);
+        }
+        synth_image(image);
+        soft.init();
+    }
+
+    // The work done between interrupts, the body of main's loop and
+    // of the hosted loop. Pending controller values are applied with
+    // the interrupts masked so the parser cannot post mid-update
+    void synth_service() {
+        if (controls.is_pending()) {
+            Xil_ExceptionDisable();
+            controls.apply(channels);
+            Xil_ExceptionEnable();
         }
+        looper.service();
+        sysex.service();
+        zones.service();
+        telemetry.service();
+        recorder.service();
+        arp.service();
+        last_state.service();
+        return;
     }
 
     void decode_volume(unsigned char x) {
@@ -29,33 +129,34 @@
         vol = Xil_In32(CTRL_REG_ADDR);
         reset = VOLUME_RST & vol;
 
-        Xil_Out32(CTRL_REG_ADDR, mask | reset);
+        synth_broadcast(CTRL_REG_ADDR, mask | reset);
         return;
     }
 
     void decode_mod_tau(unsigned char x) {
-        Xil_Out32(MOD_TAU_ADDR, x << 5);
+        midi_value amount = midi_value::from_raw(x);
+        synth_broadcast(MOD_TAU_ADDR, fixed_mult<4,28>(amount, MOD_TAU_MAX).word());
         return;
     }
 
     void decode_tau(unsigned char x) {
-        unsigned int temp = x << 8;
-        Xil_Out32(RC_ATTACK_ADDR,  x << 3);
-        Xil_Out32(RC_DECAY_ADDR,   x << 1);
-        Xil_Out32(RC_RELEASE_ADDR, x << 1);
+        midi_value amount = midi_value::from_raw(x);
+        synth_broadcast(RC_ATTACK_ADDR,  fixed_mult<2,22>(amount, RC_ATTACK_MAX).word());
+        synth_broadcast(RC_DECAY_ADDR,   fixed_mult<2,22>(amount, RC_DECAY_MAX).word());
+        synth_broadcast(RC_RELEASE_ADDR, fixed_mult<2,22>(amount, RC_DECAY_MAX).word());
         return;
     }
 
-    void modulate(unsigned char x) {
+    void modulate() {
         unsigned int mask;
 
         mask = Xil_In32(CTRL_REG_ADDR);
-        Xil_Out32(CTRL_REG_ADDR, mask ^ MOD_MASK);
+        synth_broadcast(CTRL_REG_ADDR, mask ^ MOD_MASK);
         return;
     }
 
 
-   car_mod decode_note(unsigned char x, unsigned char patch, unsigned char mod_byte) {
+   car_mod decode_note(unsigned char x, unsigned char patch) {
         car_mod notes;
         switch(x) {
             case 12  : notes.index = 0;   break;
@@ -205,8 +306,8 @@
         }
 
         if (notes.index != 255) {
-            notes.carrier = TUNING_WORD[notes.index];
-            notes.modulator = TUNING_WORD[(patch-60)+notes.index];
+            notes.carrier = tuning_word[notes.index];
+            notes.modulator = tuning_word[(patch-60)+notes.index];
         }
 
         else {
@@ -217,4 +318,45 @@
         return notes;
     }
 
+    // Capture the current settings from the register file
+    synth_state read_state() {
+        synth_state state;
+        state.ctrl = Xil_In32(CTRL_REG_ADDR);
+        state.attack = Xil_In32(RC_ATTACK_ADDR);
+        state.decay = Xil_In32(RC_DECAY_ADDR);
+        state.release = Xil_In32(RC_RELEASE_ADDR);
+        state.mod_tau = Xil_In32(MOD_TAU_ADDR);
+        state.patch = patch;
+        state.unison = channels.get_unison();
+        return state;
+    }
+
+    // Write a complete set of settings and move the
+    // sounding notes onto the new patch
+    void load_state(const synth_state &state) {
+        synth_broadcast(CTRL_REG_ADDR, state.ctrl);
+        synth_broadcast(RC_ATTACK_ADDR, state.attack);
+        synth_broadcast(RC_DECAY_ADDR, state.decay);
+        synth_broadcast(RC_RELEASE_ADDR, state.release);
+        synth_broadcast(MOD_TAU_ADDR, state.mod_tau);
+        patch = state.patch;
+        channels.set_unison(state.unison);
+        channels.toggle_modulator(patch);
+        return;
+    }
+
+    void load_preset(unsigned char x) {
+        if (x < NUM_PRESETS) {
+            load_state(presets[x]);
+        }
+        return;
+    }
 
+    // Switch the midi uart to one of the supported rates
+    bool set_baud(unsigned char x) {
+        if (x >= NUM_BAUD_RATES) {
+            return false;
+        }
+        Xil_Out32(UART_BAUD_ADDR, UART_BAUD_DIV(BAUD_RATE[x]));
+        return true;
+    }
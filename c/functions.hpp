@@ -11,12 +11,22 @@
 
     #include <stdio.h>
     #include "constants.hpp"
+    #include "tuning.hpp"
 
+    void synth_broadcast(unsigned int, unsigned int);
     void synth_init(unsigned int);
+    void synth_service();
     void decode_volume(unsigned char);
     void decode_mod_tau(unsigned char);
     void decode_tau(unsigned char);
-    void modulate(unsigned char);
-    car_mod decode_note(unsigned char, unsigned char, unsigned char);
+    void modulate();
+    car_mod decode_note(unsigned char, unsigned char);
+    synth_state read_state();
+    void load_state(const synth_state &);
+    void load_preset(unsigned char);
+    bool set_baud(unsigned char);
+
+    // Preset bank, loadable over sysex
+    extern synth_state presets[NUM_PRESETS];
 
 #endif
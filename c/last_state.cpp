@@ -0,0 +1,172 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Saving and restoring the last synth_state in storage, see
+// last_state.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include "last_state.hpp"
+#include "functions.hpp"
+#include "recorder.hpp"
+
+last_state_store last_state;
+
+static_assert(sizeof(last_state_record) <= LAST_STATE_SLOT_BYTES, "a record must fit its slot");
+static_assert(STORAGE_PAGE_BYTES % LAST_STATE_SLOT_BYTES == 0, "a slot must not cross a page");
+
+// Rotate and add over every word ahead of the check word
+static u32 record_check(const last_state_record &record) {
+    const u32 *words = (const u32 *) &record;
+    u32 x = LAST_STATE_MAGIC;
+
+    for (unsigned int i=0; i<offsetof(last_state_record, check)/4; ++i) {
+        x = ((x << 1) | (x >> 31)) + words[i];
+    }
+    return x;
+}
+
+static bool record_good(const last_state_record &record) {
+    return record.magic == LAST_STATE_MAGIC && record.check == record_check(record);
+}
+
+u32 last_state_store::offset() {
+    return sector * STORAGE_SECTOR_BYTES + slot * LAST_STATE_SLOT_BYTES;
+}
+
+// Newest good record of a sector and the number of slots in use. Slots
+// fill in order, so the first blank one is found by bisection on the
+// magic words alone and the reads at boot stay few
+bool last_state_store::newest(unsigned int s, last_state_record &record, unsigned int &used) {
+    unsigned int low = 0;
+    unsigned int high = LAST_STATE_SLOTS;
+    unsigned int mid;
+    u32 magic;
+
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (!storage_read(s * STORAGE_SECTOR_BYTES + mid * LAST_STATE_SLOT_BYTES, &magic, sizeof(magic))) {
+            return false;
+        }
+        if (magic == 0xFFFFFFFF) {
+            high = mid;
+        }
+        else {
+            low = mid+1;
+        }
+    }
+    used = low;
+
+    for (unsigned int n=used; n>0 && used-n<LAST_STATE_FALLBACK; --n) {
+        if (storage_read(s * STORAGE_SECTOR_BYTES + (n-1) * LAST_STATE_SLOT_BYTES, &record, sizeof(record)) && record_good(record)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Called from synth_init before the interrupts are on. False with no
+// storage or nothing good in it, state is left alone then. With nothing
+// stored the first write erases sector 0 before it uses it
+bool last_state_store::restore(synth_state &state) {
+    last_state_record record[STORAGE_SECTORS];
+    unsigned int used[STORAGE_SECTORS];
+    bool found = false;
+
+    if (!storage_init()) {
+        return false;
+    }
+    available = true;
+    sector = STORAGE_SECTORS-1;
+    slot = LAST_STATE_SLOTS;
+
+    for (unsigned int s=0; s<STORAGE_SECTORS; ++s) {
+        if (newest(s, record[s], used[s]) && (!found || (int) (record[s].sequence - sequence) > 0)) {
+            found = true;
+            sector = s;
+            slot = used[s];
+            sequence = record[s].sequence;
+            saved = record[s].state;
+        }
+    }
+
+    pending = saved;
+    recorder.log(RECORDER_RESTORE, found ? sequence : 0, sector * LAST_STATE_SLOTS + slot);
+    if (found) {
+        state = saved;
+    }
+    return found;
+}
+
+// Sequence number of the record restored or last written, 0 if none
+u32 last_state_store::get_sequence() {
+    return sequence;
+}
+
+// The next record into the current slot, checked on the next poll
+void last_state_store::write() {
+    out.magic = LAST_STATE_MAGIC;
+    out.sequence = sequence+1;
+    out.state = pending;
+    out.check = record_check(out);
+    storage_program(offset(), &out, sizeof(out));
+    writing = true;
+    return;
+}
+
+// Called from the main loop. Nothing waits on the flash, a poll
+// that finds it busy comes back on the next one
+void last_state_store::service() {
+    XTime now;
+    synth_state state;
+    last_state_record back;
+
+    if (!available) {
+        return;
+    }
+
+    XTime_GetTime(&now);
+    if (now - last_poll < (XTime) LAST_STATE_POLL_MS * (COUNTS_PER_SECOND / 1000)) {
+        return;
+    }
+    last_poll = now;
+    if (storage_busy()) {
+        return;
+    }
+
+    // The write has finished, a record that does not read back whole
+    // leaves its slot behind and goes again
+    if (writing) {
+        writing = false;
+        if (storage_read(offset(), &back, sizeof(back)) && memcmp(&back, &out, sizeof(out)) == 0) {
+            sequence = out.sequence;
+            saved = out.state;
+            recorder.log(RECORDER_SAVE, sequence, sector * LAST_STATE_SLOTS + slot);
+        }
+        slot += 1;
+    }
+
+    state = read_state();
+    if (memcmp(&state, &pending, sizeof(state)) != 0) {
+        pending = state;
+        changed = now;
+        return;
+    }
+    if (memcmp(&pending, &saved, sizeof(saved)) == 0 || now - changed < (XTime) LAST_STATE_SETTLE_MS * (COUNTS_PER_SECOND / 1000)) {
+        return;
+    }
+
+    // A full sector moves on to the other one, which only ever
+    // holds older records by now
+    if (slot >= LAST_STATE_SLOTS) {
+        sector = (sector+1) % STORAGE_SECTORS;
+        slot = 0;
+        storage_erase(sector * STORAGE_SECTOR_BYTES);
+        return;
+    }
+    write();
+    return;
+}
@@ -0,0 +1,91 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: The last synth_state kept in storage, so a power cycle comes
+// back with the sound the player left rather than the power up defaults.
+// synth_init restores it into the boot register image before the interrupts
+// are on. service() polls the registers from the main loop and writes a new
+// record once the settings have been left alone for LAST_STATE_SETTLE_MS, so
+// a sweep of a knob costs one write.
+//
+// Records are appended to the slots of one sector, and once it is full the
+// other sector is erased and takes over. The newest record is never in the
+// sector being erased, so a power loss at any point leaves a whole record.
+// Each record is read back after it is written, a bad one is skipped and
+// written again to the next slot. On restore the highest sequence number
+// with a good check word wins.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_LAST_STATE_HPP
+#define MYLIB_LAST_STATE_HPP
+
+#include <stdio.h>
+#include <stddef.h>
+#include "xil_types.h"
+#include "xtime_l.h"
+#include "constants.hpp"
+#include "storage.hpp"
+
+    #define LAST_STATE_MAGIC        0x4C535431
+    #define LAST_STATE_SLOT_BYTES   64
+    #define LAST_STATE_SLOTS        (STORAGE_SECTOR_BYTES / LAST_STATE_SLOT_BYTES)
+
+    // Register poll period, and how long the settings must hold before a write
+    #define LAST_STATE_POLL_MS      100
+    #define LAST_STATE_SETTLE_MS    1000
+
+    // Slots back from the newest that restore will try before giving up on a sector
+    #define LAST_STATE_FALLBACK     4
+
+    /*
+    One slot of the storage area
+        -magic      : LAST_STATE_MAGIC, a blank slot reads 0xFFFFFFFF
+        -sequence   : counts up with every record written
+        -state      : the settings
+        -check      : rotate and add of the words above, a torn write fails it
+    */
+    struct last_state_record {
+        u32 magic;
+        u32 sequence;
+        synth_state state;
+        u32 check;
+    };
+
+class last_state_store {
+    bool available;
+    unsigned int sector;
+    unsigned int slot;
+    u32 sequence;
+    synth_state saved;
+    synth_state pending;
+    last_state_record out;
+    XTime changed;
+    XTime last_poll;
+    bool writing;
+
+    u32 offset();
+    bool newest(unsigned int, last_state_record &, unsigned int &);
+    void write();
+
+    public:
+
+        last_state_store() {
+            available = false;
+            sector = 0;
+            slot = 0;
+            sequence = 0;
+            changed = 0;
+            last_poll = 0;
+            writing = false;
+        }
+
+        bool restore(synth_state &);
+        u32 get_sequence();
+        void service();
+};
+
+    extern last_state_store last_state;
+
+#endif
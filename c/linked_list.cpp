@@ -10,12 +10,17 @@
 #include "xil_printf.h"
 #include "xil_io.h"
 #include "linked_list.hpp"
+#include "functions.hpp"
+#include "telemetry.hpp"
+#include "soft_link.hpp"
+#include "recorder.hpp"
 
 // Function to append a node to the list
-void linked_list::append_node(unsigned int channel) {
+void linked_list::append_node(unsigned int bank, unsigned int channel) {
     // Create new node
     node *tmp = new node;
     tmp->next = NULL;
+    tmp->bank = bank;
     tmp->chan_num = channel;
 
     // If this is the first node,
@@ -34,20 +39,23 @@ void linked_list::append_node(unsigned int channel) {
 }
 
 
-// Set available to high when interrupt is seen
-void linked_list::make_available() {
+// Set available to high when the bank's interrupt is seen,
+// each bank keeps its own reset queue
+void linked_list::make_available(unsigned int bank) {
     node *tmp = head;
     while (tmp != NULL) {
-        if (tmp->awaiting_reset != 0) {
+        if (tmp->bank == bank && tmp->awaiting_reset != 0) {
             if (tmp->awaiting_reset == 1) {
                 tmp->awaiting_reset = 0;
-                Xil_Out32(VEL_BASE_ADDR + 4*tmp->chan_num, 0);
-                Xil_Out32(MOD_BASE_ADDR + 4*tmp->chan_num, 0);
-                Xil_Out32(CAR_BASE_ADDR + 4*tmp->chan_num, 0);
+                synth_out32(VEL_ADDR(tmp->bank, tmp->chan_num), 0);
+                synth_out32(MOD_ADDR(tmp->bank, tmp->chan_num), 0);
+                synth_out32(CAR_ADDR(tmp->bank, tmp->chan_num), 0);
                 tmp->note = 0;
                 tmp->mod = 0;
                 tmp->index = 255;
+                tmp->key = 255;
                 tmp->available = true;
+                recorder.log(RECORDER_FREE, tmp->bank, tmp->chan_num);
             }
 
             else {
@@ -60,100 +68,491 @@ void linked_list::make_available() {
 }
 
 
+// Scale a tuning word by a 2.30 fixed point detune ratio
+static unsigned int detune_word(unsigned int word, unsigned int ratio) {
+    return (unsigned int) fixed_mult<32,0>(tuning_fmt::from_word(word), detune_ratio::from_word(ratio)).word();
+}
+
+// Velocity register word, the attack level sits in 31:16
+static unsigned int velocity_word(env_level attack) {
+    return (unsigned int) attack.word() << 16;
+}
+
+// Velocity register word of a note on velocity
+static unsigned int velocity_on(unsigned char velocity) {
+    return velocity_word(velocity_fmt::from_raw(velocity).convert<2,14>());
+}
+
+
 // Traverse the linked list and keep track of whether
-// the note is being played, and how many paths are
-// waiting to be reset
-info linked_list::in_use(unsigned int note) {
+// the key is being played from the midi channel, and how
+// many paths of each bank are waiting to be reset. Every
+// channel of a group shares one place in its bank's reset queue
+info linked_list::in_use(unsigned char key, unsigned char source) {
     node *tmp = head;
     info note_info;
     while (tmp != NULL) {
-        if (tmp->note == note) {
+        if (!tmp->available && tmp->key == key && tmp->source == source) {
             note_info.in_use = true;
             note_info.index = tmp;
             note_info.awaiting_rst = tmp->awaiting_reset;
         }
-        if (tmp->awaiting_reset != 0) {
-            note_info.rst_cnt += 1;
+        if (tmp->awaiting_reset > note_info.rst_cnt[tmp->bank]) {
+            note_info.rst_cnt[tmp->bank] = tmp->awaiting_reset;
         }
         tmp = tmp->next;
     }
     return note_info;
 }
 
-// Traverse through the linked list and play the note on the first
-// available channel
-void linked_list::note_on(car_mod note, unsigned char velocity) {
-        info note_info = in_use(note.carrier);
+// Loudest envelope of the group a channel belongs to, channels the
+// hardware reports idle have finished and count as silent. Held is set
+// while any channel of the group is still waiting on its note off
+static unsigned int group_level(node *head, node *member, unsigned int env[NUM_BANKS][NUM_CHANNELS], bool *held) {
+    node *tmp = head;
+    unsigned int level = 0;
+    unsigned int word;
+
+    *held = false;
+    while (tmp != NULL) {
+        if (!tmp->available && tmp->group == member->group) {
+            word = env[tmp->bank][tmp->chan_num];
+            if (ENV_STAGE(word) != ENV_STAGE_IDLE && ENV_LEVEL(word) > level) {
+                level = ENV_LEVEL(word);
+            }
+            if (tmp->awaiting_reset == 0) {
+                *held = true;
+            }
+        }
+        tmp = tmp->next;
+    }
+    return level;
+}
+
+// Free the group that will be missed least. Groups that have already
+// faded out are reclaimed first, then released groups, then the
+// quietest and finally the oldest. The envelope block of each bank is
+// read in one sequential run. Returns false if there is nothing to steal
+bool linked_list::steal() {
+    node *tmp = head;
+    node *victim = NULL;
+    unsigned int env[NUM_BANKS][NUM_CHANNELS];
+    unsigned int level;
+    unsigned int victim_level = 0;
+    bool held;
+    bool victim_held = false;
+
+    for (unsigned int b=0; b<NUM_BANKS; ++b) {
+        for (unsigned int i=0; i<NUM_CHANNELS; ++i) {
+            env[b][i] = Xil_In32(ENV_ADDR(b, i));
+        }
+    }
+
+    while (tmp != NULL) {
+        if (!tmp->available) {
+            level = group_level(head, tmp, env, &held);
+            if (victim == NULL) {
+                victim = tmp;
+                victim_level = level;
+                victim_held = held;
+            }
+            else if ((level < ENV_INAUDIBLE) != (victim_level < ENV_INAUDIBLE)) {
+                if (level < ENV_INAUDIBLE) {
+                    victim = tmp;
+                    victim_level = level;
+                    victim_held = held;
+                }
+            }
+            else if (held != victim_held) {
+                if (!held) {
+                    victim = tmp;
+                    victim_level = level;
+                    victim_held = held;
+                }
+            }
+            else if (level < victim_level || (level == victim_level && tmp->age < victim->age)) {
+                victim = tmp;
+                victim_level = level;
+                victim_held = held;
+            }
+        }
+        tmp = tmp->next;
+    }
+
+    if (victim == NULL) {
+        return false;
+    }
+
+    // Only a voice that could still be heard counts as stolen
+    if (victim_level >= ENV_INAUDIBLE) {
+        telemetry.count.notes_stolen += 1;
+    }
+    recorder.log(RECORDER_STEAL, victim->group | (victim->bank << 8) | (victim->chan_num << 16), victim_level | ((u32) victim_held << 31));
+    release_group(victim);
+    return true;
+}
+
+// Whether any channel in use belongs to the group
+bool linked_list::group_held(unsigned char group) {
+    node *tmp = head;
+
+    while (tmp != NULL) {
+        if (!tmp->available && tmp->group == group) {
+            return true;
+        }
+        tmp = tmp->next;
+    }
+    return false;
+}
+
+// Cut every channel of a group and return it to the free pool. If the
+// group was waiting on a reset queue, the groups behind it move up
+void linked_list::release_group(node *member) {
+    node *tmp = head;
+    unsigned char group = member->group;
+    int slot[NUM_BANKS] = {};
+
+    // A group spread over several banks holds a place in each queue
+    while (tmp != NULL) {
+        if (!tmp->available && tmp->group == group) {
+            slot[tmp->bank] = tmp->awaiting_reset;
+        }
+        tmp = tmp->next;
+    }
+
+    tmp = head;
+    while (tmp != NULL) {
+        if (!tmp->available && tmp->group == group) {
+            synth_out32(CAR_ADDR(tmp->bank, tmp->chan_num), 0);
+            tmp->note = 0;
+            tmp->mod = 0;
+            tmp->index = 255;
+            tmp->key = 255;
+            tmp->awaiting_reset = 0;
+            tmp->available = true;
+            tmp->enable = false;
+        }
+        else if (slot[tmp->bank] != 0 && tmp->awaiting_reset > slot[tmp->bank]) {
+            tmp->awaiting_reset -= 1;
+        }
+        tmp = tmp->next;
+    }
+    return;
+}
+
+// Channels free on the enabled banks
+unsigned int linked_list::free_channels() {
+    node *tmp = head;
+    unsigned int count = 0;
+
+    while (tmp != NULL) {
+        if (tmp->available && bank_enabled[tmp->bank]) {
+            count += 1;
+        }
+        tmp = tmp->next;
+    }
+    return count;
+}
+
+// Collect up to count free channels, stealing whole groups until
+// enough channels are free. Each channel goes to the enabled bank
+// with the fewest busy channels so the banks fill evenly
+unsigned int linked_list::gather(node **voices, unsigned int count) {
+    node *tmp;
+    unsigned int found;
+    unsigned int load[NUM_BANKS];
+    unsigned int free[NUM_BANKS];
+    unsigned int take[NUM_BANKS];
+    unsigned int best;
+
+    while (true) {
+        found = 0;
+        for (unsigned int b=0; b<NUM_BANKS; ++b) {
+            load[b] = 0;
+            free[b] = 0;
+            take[b] = 0;
+        }
+
+        tmp = head;
+        while (tmp != NULL) {
+            if (!tmp->available) {
+                load[tmp->bank] += 1;
+            }
+            else if (bank_enabled[tmp->bank]) {
+                free[tmp->bank] += 1;
+            }
+            tmp = tmp->next;
+        }
+
+        // Hand out the picks one at a time to the least loaded bank
+        while (found < count) {
+            best = NUM_BANKS;
+            for (unsigned int b=0; b<NUM_BANKS; ++b) {
+                if (free[b] != 0 && (best == NUM_BANKS || load[b] < load[best])) {
+                    best = b;
+                }
+            }
+            if (best == NUM_BANKS) {
+                break;
+            }
+            load[best] += 1;
+            free[best] -= 1;
+            take[best] += 1;
+            found += 1;
+        }
+
+        if (found == count || !steal()) {
+            break;
+        }
+    }
+
+    // Voices are listed bank by bank so note_on writes each bank in one run
+    found = 0;
+    for (unsigned int b=0; b<NUM_BANKS; ++b) {
+        tmp = head;
+        while (tmp != NULL && take[b] != 0) {
+            if (tmp->bank == b && tmp->available) {
+                voices[found] = tmp;
+                found += 1;
+                take[b] -= 1;
+            }
+            tmp = tmp->next;
+        }
+    }
+    return found;
+}
+
+// Channels sounding a held note and channels left to release
+void linked_list::count_voices(unsigned int *active, unsigned int *releasing) {
+    node *tmp = head;
+
+    *active = 0;
+    *releasing = 0;
+    while (tmp != NULL) {
+        if (!tmp->available) {
+            if (tmp->awaiting_reset != 0) {
+                *releasing += 1;
+            }
+            else {
+                *active += 1;
+            }
+        }
+        tmp = tmp->next;
+    }
+    return;
+}
+
+// Select how many detuned channels each note on allocates
+void linked_list::set_unison(unsigned char count) {
+    if (count < 1) {
+        unison = 1;
+    }
+    else if (count > UNISON_MAX) {
+        unison = UNISON_MAX;
+    }
+    else {
+        unison = count;
+    }
+    return;
+}
+
+unsigned char linked_list::get_unison() {
+    return unison;
+}
+
+// Play on the first count banks only. Groups sounding on a bank
+// that is switched off are cut so its channels come back clean
+void linked_list::set_banks(unsigned char count) {
+    node *tmp = head;
+
+    if (count < 1) {
+        count = 1;
+    }
+    for (unsigned int b=0; b<NUM_BANKS; ++b) {
+        bank_enabled[b] = (b < count);
+    }
+
+    while (tmp != NULL) {
+        if (!bank_enabled[tmp->bank] && !tmp->available) {
+            release_group(tmp);
+        }
+        tmp = tmp->next;
+    }
+    return;
+}
+
+// Allocate a group of channels for every layer of the key and play
+// them. The layers share one group so they are released and stolen
+// together, their words are staged first and written as one batch
+void linked_list::note_on(unsigned char key, unsigned char source, const zone_voice *layers, unsigned int layer_count) {
+        info note_info = in_use(key, source);
         node *tmp = head;
-        unsigned int attack = velocity << 24;
-        unsigned int decay = velocity << 6;
-        // unsigned int decay = velocity << 8;
-        unsigned int velocity_in = attack;
-        // unsigned int velocity_in = attack | decay;
-
-    // If the note is not currently being played, then select the first
-    // available channel and play the note
+        node *voices[ZONE_LAYERS*UNISON_MAX];
+        unsigned int car_words[ZONE_LAYERS*UNISON_MAX];
+        unsigned int mod_words[ZONE_LAYERS*UNISON_MAX];
+        unsigned int vel_words[ZONE_LAYERS*UNISON_MAX];
+        const zone_voice *fabric[ZONE_LAYERS];
+        unsigned int fabric_count = 0;
+        unsigned int count;
+        unsigned int share;
+        unsigned int matched = 0;
+        unsigned int id;
+        unsigned int velocity_in;
+        unsigned char group;
+
+    // If the key is not currently being played, then select the first
+    // available channels and play every layer
     if (note_info.in_use == false) {
-        while (tmp != NULL) {
-            if (tmp->available) {
-                tmp->note = note.carrier;
-                tmp->mod = note.modulator;
-                tmp->index = note.index;
-                Xil_Out32(VEL_BASE_ADDR + 4*tmp->chan_num, velocity_in);
-                Xil_Out32(MOD_BASE_ADDR + 4*tmp->chan_num, note.modulator);
-                Xil_Out32(CAR_BASE_ADDR + 4*tmp->chan_num, (note.carrier | MASK_ON));
+        // Once the fabric is full a layer spills to a software
+        // voice on the second core before anything is stolen
+        for (unsigned int l=0; l<layer_count; ++l) {
+            id = VOICE_ID(key, source, layers[l].zone);
+            velocity_in = velocity_on(layers[l].velocity);
+            if ((soft.holds(id) || free_channels() < unison * (fabric_count+1)) && soft.note_on(id, layers[l].note.carrier, layers[l].note.modulator, velocity_in)) {
+                recorder.log(RECORDER_SPILL, layers[l].note.carrier, velocity_in);
+            }
+            else {
+                fabric[fabric_count] = &layers[l];
+                fabric_count += 1;
+            }
+        }
+        if (fabric_count == 0) {
+            return;
+        }
+
+        count = gather(voices, unison * fabric_count);
+        if (count == 0) {
+            telemetry.count.notes_dropped += 1;
+            recorder.log(RECORDER_DROP, fabric[0]->note.carrier, 0);
+            return;
+        }
+
+        // Ids wrap, skip any still held by a sounding or releasing group
+        do {
+            group_count = (group_count == 255) ? 1 : group_count+1;
+        } while (group_held(group_count));
+        age_count += 1;
+
+        // Each layer takes an even share of what was found, the
+        // first layers take one more if it does not divide
+        for (unsigned int l=0, first=0; l<fabric_count; ++l, first+=share) {
+            share = count / fabric_count + ((l < count % fabric_count) ? 1 : 0);
+            for (unsigned int i=0; i<share; ++i) {
+                tmp = voices[first+i];
+                tmp->note = fabric[l]->note.carrier;
+                tmp->mod = fabric[l]->note.modulator;
+                tmp->index = fabric[l]->note.index;
+                tmp->velocity = fabric[l]->velocity;
+                tmp->key = key;
+                tmp->source = source;
+                tmp->zone = fabric[l]->zone;
+                tmp->patch = fabric[l]->patch;
+                tmp->group = group_count;
+                tmp->detune = UNISON_DETUNE[share-1][i];
+                tmp->age = age_count;
                 tmp->available = false;
                 tmp->enable = true;
-                return;
+                car_words[first+i] = detune_word(tmp->note, tmp->detune);
+                mod_words[first+i] = detune_word(tmp->mod, tmp->detune);
+                vel_words[first+i] = velocity_on(tmp->velocity);
             }
-            else {
-                tmp = tmp->next;
+        }
+        recorder.log(RECORDER_NOTE_ON, key | (source << 8), group_count | (count << 8) | (voices[0]->bank << 16) | (voices[0]->chan_num << 24));
+
+        // One batch per bank, the voices are in bank order
+        for (unsigned int first=0, last=0; first<count; first=last) {
+            while (last < count && voices[last]->bank == voices[first]->bank) {
+                last += 1;
+            }
+            for (unsigned int i=first; i<last; ++i) {
+                synth_out32(VEL_ADDR(voices[i]->bank, voices[i]->chan_num), vel_words[i]);
+            }
+            for (unsigned int i=first; i<last; ++i) {
+                synth_out32(MOD_ADDR(voices[i]->bank, voices[i]->chan_num), mod_words[i]);
+            }
+            for (unsigned int i=first; i<last; ++i) {
+                synth_out32(CAR_ADDR(voices[i]->bank, voices[i]->chan_num), (car_words[i] | MASK_ON));
             }
         }
+        telemetry.note_played();
     }
-        
-    // If the note is being played but has been turned off and is awaiting the
-    // hardware interrupt, then re-enable the channel and note
+
+    // If the key is being played but has been turned off and is awaiting the
+    // hardware interrupt, then re-enable every channel of the group at the
+    // velocity of its layer. Layers that had spilled start their software voice again
     else if (note_info.awaiting_rst != 0) {
-        tmp = note_info.index;
-        tmp->awaiting_reset = 0;
-        Xil_Out32(VEL_BASE_ADDR + 4*tmp->chan_num, velocity_in);
-        Xil_Out32(CAR_BASE_ADDR + 4*tmp->chan_num, (note.carrier | MASK_ON));
-        tmp->enable = true;
+        group = note_info.index->group;
+        recorder.log(RECORDER_RETRIGGER, key | (source << 8), group);
+        while (tmp != NULL) {
+            if (!tmp->available && tmp->group == group) {
+                for (unsigned int l=0; l<layer_count; ++l) {
+                    if (layers[l].zone == tmp->zone) {
+                        tmp->velocity = layers[l].velocity;
+                        matched |= 1 << l;
+                    }
+                }
+                tmp->awaiting_reset = 0;
+                synth_out32(VEL_ADDR(tmp->bank, tmp->chan_num), velocity_on(tmp->velocity));
+                synth_out32(CAR_ADDR(tmp->bank, tmp->chan_num), (detune_word(tmp->note, tmp->detune) | MASK_ON));
+                tmp->enable = true;
+            }
+            tmp = tmp->next;
+        }
+        for (unsigned int l=0; l<layer_count; ++l) {
+            if ((matched & (1 << l)) == 0) {
+                soft.note_on(VOICE_ID(key, source, layers[l].zone), layers[l].note.carrier, layers[l].note.modulator, velocity_on(layers[l].velocity));
+            }
+        }
     }
     return;
 }
 
-// Traverse the linked list, find which channel
-// is playing the note, and turn it off
-void linked_list::note_off(car_mod note) {
-        info note_info = in_use(note.carrier);
+// Release the software voices of every layer of the key, then
+// find which group is playing it and turn the group off
+void linked_list::note_off(unsigned char key, unsigned char source) {
+        info note_info = in_use(key, source);
         node *tmp = head;
+        unsigned char group;
+        bool spilled = false;
 
-    // If the note is currently being played then set the enable bit to 0 and 
-    // set the reset counter to the last in line
-    if (note_info.in_use == true) {
-        tmp = note_info.index;
-        tmp->awaiting_reset = note_info.rst_cnt+1;
-        Xil_Out32((CAR_BASE_ADDR + 4*tmp->chan_num), (note.carrier & MASK_OFF));
-        tmp->enable = false;
+    for (unsigned int z=0; z<ZONES_MAX; ++z) {
+        if (soft.note_off(VOICE_ID(key, source, z))) {
+            spilled = true;
+        }
+    }
+
+    // If the key is currently being played then set the enable bit to 0 and
+    // set the reset counter of the whole group to the last in line
+    if (note_info.in_use == true && note_info.awaiting_rst == 0) {
+        group = note_info.index->group;
+        recorder.log(RECORDER_NOTE_OFF, key | (source << 8), group);
+        while (tmp != NULL) {
+            if (!tmp->available && tmp->group == group) {
+                tmp->awaiting_reset = note_info.rst_cnt[tmp->bank]+1;
+                synth_out32(CAR_ADDR(tmp->bank, tmp->chan_num), (detune_word(tmp->note, tmp->detune) & MASK_OFF));
+                tmp->enable = false;
+            }
+            tmp = tmp->next;
+        }
+    }
+    else {
+        recorder.log(RECORDER_NOTE_OFF, key | (source << 8), spilled ? 0 : RECORDER_NOT_HELD);
     }
     return;
 }
 
-// Traverse the linked list and apply the new modulation patch to 
-// every note currently being played
-void linked_list::toggle_modulator(car_mod note, unsigned char patch) {
+// Traverse the linked list and apply the new modulation patch to
+// every note currently being played by a zone that follows it
+void linked_list::toggle_modulator(unsigned char patch) {
     node *tmp = head;
     unsigned int mod_word = 0;
 
     while (tmp != NULL) {
 
-        mod_word = TUNING_WORD[(patch-60)+tmp->index];
-
-        if (!tmp->available) {
+        if (!tmp->available && tmp->patch == ZONE_PATCH_LIVE) {
+            mod_word = tuning_word[(patch-60)+tmp->index];
             tmp->mod = mod_word;
-            Xil_Out32(MOD_BASE_ADDR + 4*tmp->chan_num, mod_word);
+            synth_out32(MOD_ADDR(tmp->bank, tmp->chan_num), detune_word(mod_word, tmp->detune));
         }
         tmp = tmp->next;
     }
@@ -166,36 +565,86 @@ void linked_list::modulate(unsigned char x) {
     node *tmp = head;
     while (tmp != NULL) {
         if (tmp->enable == true) {
-            tmp->mod = TUNING_WORD[x];
-            Xil_Out32(MOD_BASE_ADDR + 4*tmp->chan_num, tmp->mod);
+            tmp->mod = tuning_word[x];
+            synth_out32(MOD_ADDR(tmp->bank, tmp->chan_num), detune_word(tmp->mod, tmp->detune));
+        }
+        tmp = tmp->next;
+    }
+    return;
+}
+
+// Move every channel that is sounding or releasing onto the active
+// tuning table, each on the patch of its zone. The words are staged
+// first and then written as one batch
+void linked_list::retune(unsigned char patch) {
+    node *tmp = head;
+    node *voices[NUM_BANKS*NUM_CHANNELS];
+    unsigned int count = 0;
+
+    while (tmp != NULL) {
+        if (!tmp->available && tmp->index != 255) {
+            tmp->note = tuning_word[tmp->index];
+            tmp->mod = tuning_word[(((tmp->patch == ZONE_PATCH_LIVE) ? patch : tmp->patch)-60)+tmp->index];
+            voices[count] = tmp;
+            count += 1;
         }
         tmp = tmp->next;
     }
+
+    for (unsigned int i=0; i<count; ++i) {
+        synth_out32(MOD_ADDR(voices[i]->bank, voices[i]->chan_num), detune_word(voices[i]->mod, voices[i]->detune));
+    }
+    for (unsigned int i=0; i<count; ++i) {
+        tmp = voices[i];
+        if (tmp->enable) {
+            synth_out32(CAR_ADDR(tmp->bank, tmp->chan_num), (detune_word(tmp->note, tmp->detune) | MASK_ON));
+        }
+        else {
+            synth_out32(CAR_ADDR(tmp->bank, tmp->chan_num), (detune_word(tmp->note, tmp->detune) & MASK_OFF));
+        }
+    }
     return;
 }
 
-// Apply pitch bend
-void linked_list::bend_pitch(unsigned int x) {
+// Apply pitch bend to the notes played on a midi channel
+void linked_list::bend_pitch(unsigned char source, unsigned int x) {
     node *tmp = head;
-    unsigned int bend = x & 0x00001FFF;
-    unsigned int bend_up;
-    unsigned int bend_down;
-    unsigned int sign = x >> 13;
-    unsigned int diff_up;
-    unsigned int diff_down;
-    unsigned int interval_up;
-    unsigned int interval_down;
+    // Signed fraction of a semitone, -1 to just under +1
+    Fixed<1,13> amount = Fixed<1,13>::from_raw((int) (x & 0x00003FFF) - 8192);
+    tuning_fmt note;
+    tuning_fmt interval;
     unsigned int new_note;
     while (tmp != NULL) {
-        if (tmp->enable == true) {
-            diff_up   = (TUNING_WORD[tmp->index+1] - tmp->note);
-            diff_down = (tmp->note - TUNING_WORD[tmp->index-1]);
-            interval_up   = diff_up   >> 13;
-            interval_down = diff_down >> 13;
-            bend_up = bend*interval_up;
-            bend_down = (8192-bend)*interval_down;
-            new_note = sign ? tmp->note+bend_up : tmp->note-bend_down;
-            Xil_Out32(CAR_BASE_ADDR + 4*tmp->chan_num, new_note | MASK_ON);
+        if (tmp->enable == true && tmp->source == source) {
+            note = tuning_fmt::from_word(tmp->note);
+            if (amount.bits() < 0) {
+                interval = tuning_fmt::from_word(tmp->note - tuning_word[tmp->index-1]);
+            }
+            else {
+                interval = tuning_fmt::from_word(tuning_word[tmp->index+1] - tmp->note);
+            }
+            new_note = (unsigned int) fixed_add<32,0>(note, fixed_mult<32,0>(interval, amount)).word();
+            synth_out32(CAR_ADDR(tmp->bank, tmp->chan_num), detune_word(new_note, tmp->detune) | MASK_ON);
+        }
+        tmp = tmp->next;
+    }
+    return;
+}
+
+// Find the channels playing the key on a midi channel and raise
+// their level from the note on velocity towards full scale
+void linked_list::apply_pressure(unsigned char source, unsigned char key, unsigned char pressure) {
+        node *tmp = head;
+        velocity_fmt full_scale = velocity_fmt::from_raw(127);
+        velocity_fmt start;
+        env_level level;
+
+    // Notes that have been released are left to decay
+    while (tmp != NULL) {
+        if (!tmp->available && tmp->key == key && tmp->source == source && tmp->awaiting_reset == 0) {
+            start = velocity_fmt::from_raw(tmp->velocity);
+            level = (start + (full_scale - start) * midi_value::from_raw(pressure)).convert<2,14>();
+            synth_out32(VEL_ADDR(tmp->bank, tmp->chan_num), velocity_word(level));
         }
         tmp = tmp->next;
     }
@@ -11,29 +11,52 @@
 
 #include <stdio.h>
 #include "constants.hpp"
+#include "zones.hpp"
 
 class linked_list {
     node *head;
     node *tail;
+    unsigned char unison;
+    unsigned char group_count;
+    unsigned int age_count;
+    bool bank_enabled[NUM_BANKS];
+
+    unsigned int gather(node **, unsigned int);
+    bool steal();
+    unsigned int free_channels();
+    void release_group(node *);
+    bool group_held(unsigned char);
 
     public:
 
         linked_list() {
             head = NULL;
-
-            for (unsigned int i=0; i<NUM_CHANNELS; ++i) {
-                append_node(i);
+            unison = 1;
+            group_count = 0;
+            age_count = 0;
+
+            for (unsigned int bank=0; bank<NUM_BANKS; ++bank) {
+                bank_enabled[bank] = true;
+                for (unsigned int i=0; i<NUM_CHANNELS; ++i) {
+                    append_node(bank, i);
+                }
             }
         }
 
-        void append_node(unsigned int);
-        void make_available();
-        info in_use(unsigned int);
-        void note_on(car_mod, unsigned char);
-        void note_off(car_mod);
-        void toggle_modulator(car_mod, unsigned char);
+        void append_node(unsigned int, unsigned int);
+        void make_available(unsigned int);
+        info in_use(unsigned char, unsigned char);
+        void note_on(unsigned char, unsigned char, const zone_voice *, unsigned int);
+        void note_off(unsigned char, unsigned char);
+        void toggle_modulator(unsigned char);
         void modulate(unsigned char);
-        void bend_pitch(unsigned int);
+        void retune(unsigned char);
+        void bend_pitch(unsigned char, unsigned int);
+        void apply_pressure(unsigned char, unsigned char, unsigned char);
+        void set_unison(unsigned char);
+        unsigned char get_unison();
+        void set_banks(unsigned char);
+        void count_voices(unsigned int *, unsigned int *);
 };
 
 #endif
@@ -0,0 +1,408 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Recording, playback and export of the midi looper, see looper.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "xil_printf.h"
+#include "xil_io.h"
+#include "xil_exception.h"
+#include "xtime_l.h"
+#include "looper.hpp"
+
+// Recording arena, allocated once in DDR so capture never touches the heap
+static unsigned int loop_arena[LOOP_EVENTS];
+
+// Current time in looper ticks
+static unsigned int loop_tick() {
+    XTime now;
+    XTime_GetTime(&now);
+    return (unsigned int) (now >> LOOP_TICK_SHIFT);
+}
+
+// Ticks between a record and the one before it
+static unsigned int loop_delta(unsigned int record) {
+    return (record >> 24) == 0 ? (record & 0x00FFFFFF) : (record & 0x000000FF);
+}
+
+// Number of data bytes that follow a status byte
+static unsigned int loop_data_bytes(unsigned char status) {
+    switch (status & 0xF0) {
+        case PROGRAM_CHANGE     : return 1;
+        case CHANNEL_AFTERTOUCH : return 1;
+        case 0xF0               : return 0;
+        default                 : return 2;
+    }
+}
+
+midi_looper::midi_looper() {
+    arena = loop_arena;
+    mode = LOOP_IDLE;
+    export_pending = false;
+    overflow = false;
+    wr = 0;
+    current = 0;
+    shift = 0;
+    length = 0;
+    last_tick = 0;
+    start_tick = 0;
+    loop_ticks = 0;
+    rd = 0;
+    loop_start = 0;
+    play_tick = 0;
+    export_step = EXPORT_IDLE;
+    export_rd = 0;
+    export_delta = 0;
+    export_elapsed = 0;
+    export_bytes = 0;
+
+    for (unsigned int c=0; c<NUM_MIDI_CHANNELS; ++c) {
+        for (unsigned int i=0; i<4; ++i) {
+            notes_on[c][i] = 0;
+        }
+    }
+}
+
+// Open a new record for a status byte
+void midi_looper::open(unsigned char byte) {
+    unsigned int tick;
+    unsigned int delta;
+
+    if (wr >= LOOP_EVENTS-1) {
+        overflow = true;
+        shift = 0;
+        return;
+    }
+
+    tick = loop_tick();
+    delta = tick - last_tick;
+    last_tick = tick;
+
+    if (delta > 0xFF) {
+        arena[wr] = delta & 0x00FFFFFF;
+        wr += 1;
+        delta = 0;
+    }
+
+    current = wr;
+    arena[wr] = (byte << 24) | delta;
+    wr += 1;
+    shift = 16;
+    return;
+}
+
+// Called from the uart interrupt for every byte. A status byte opens a new
+// record and data bytes are or'ed into it, so the cost per byte is fixed.
+// A data byte after a complete channel message is running status and
+// opens a record with the same status
+void midi_looper::capture(unsigned char byte) {
+    unsigned char status;
+
+    if (mode != LOOP_RECORD) {
+        return;
+    }
+
+    if (byte & 0x80) {
+        open(byte);
+        return;
+    }
+
+    status = arena[current] >> 24;
+    if (shift == 0 && wr != 0 && !overflow && status >= 0x80 && status < 0xF0) {
+        open(status);
+    }
+
+    if (shift != 0) {
+        arena[current] |= byte << shift;
+        shift = (shift == 16 && loop_data_bytes(status) == 2) ? 8 : 0;
+    }
+    return;
+}
+
+// Close the recording. The control change that ended it has already
+// been captured, on whichever channel it came, so it is dropped again
+void midi_looper::finish_recording(unsigned int tick) {
+    if (wr != 0 && ((arena[current] >> 24) & 0xF0) == CONTROL_CHANGE && ((arena[current] >> 16) & 0xFF) == LOOPER) {
+        wr = current;
+    }
+    length = wr;
+    loop_ticks = tick - start_tick;
+    shift = 0;
+    return;
+}
+
+void midi_looper::start_playback(unsigned int tick) {
+    rd = 0;
+    loop_start = tick;
+    play_tick = tick;
+    mode = LOOP_PLAY;
+    return;
+}
+
+// Release every note the loop is still holding, on the channel it was played on
+void midi_looper::stop_playback() {
+    unsigned int bits;
+    unsigned char note;
+
+    for (unsigned int c=0; c<NUM_MIDI_CHANNELS; ++c) {
+        for (unsigned int i=0; i<4; ++i) {
+            bits = notes_on[c][i];
+            notes_on[c][i] = 0;
+            while (bits != 0) {
+                note = (i << 5) + __builtin_ctz(bits);
+                bits &= bits - 1;
+                parser.parse(NOTE_OFF | c);
+                parser.parse(note);
+                parser.parse(0);
+            }
+        }
+    }
+    return;
+}
+
+// Handle a LOOPER control change, called from the live parser
+void midi_looper::command(unsigned char x) {
+    unsigned int tick = loop_tick();
+
+    if (mode == LOOP_RECORD) {
+        finish_recording(tick);
+    }
+    else if (mode == LOOP_PLAY) {
+        stop_playback();
+    }
+    mode = LOOP_IDLE;
+
+    switch (x) {
+        case LOOP_RECORD :
+            wr = 0;
+            shift = 0;
+            overflow = false;
+            start_tick = tick;
+            last_tick = tick;
+            mode = LOOP_RECORD;
+            break;
+
+        case LOOP_PLAY :
+            if (length != 0) {
+                start_playback(tick);
+            }
+            break;
+
+        case LOOP_EXPORT :
+            export_pending = true;
+            break;
+
+        default :
+            break;
+    }
+    return;
+}
+
+// Feed one record to the loop parser
+void midi_looper::fire(unsigned int record) {
+    unsigned char status = record >> 24;
+    unsigned char data_1 = (record >> 16) & 0x7F;
+    unsigned char data_2 = (record >> 8) & 0x7F;
+    unsigned int count = loop_data_bytes(status);
+    unsigned int *held = notes_on[status & 0x0F];
+    unsigned int word = data_1 >> 5;
+    unsigned int bit = 1 << (data_1 & 0x1F);
+
+    if (status == 0 || status >= 0xF0) {
+        return;
+    }
+
+    if ((status & 0xF0) == NOTE_ON && data_2 != 0) {
+        held[word] |= bit;
+    }
+    else if ((status & 0xF0) == NOTE_OFF || (status & 0xF0) == NOTE_ON) {
+        held[word] &= ~bit;
+    }
+
+    parser.parse(status);
+    parser.parse(data_1);
+    if (count == 2) {
+        parser.parse(data_2);
+    }
+    return;
+}
+
+// Called from the main loop. Plays every record that is due and
+// restarts the loop once its full length has elapsed
+void midi_looper::service() {
+    unsigned int tick;
+    unsigned int due;
+
+    if (export_pending) {
+        export_pending = false;
+        export_step = EXPORT_SIZE;
+        export_rd = 0;
+        export_delta = 0;
+        export_elapsed = 0;
+        export_bytes = 0;
+    }
+    if (export_step != EXPORT_IDLE) {
+        export_next();
+    }
+
+    if (mode != LOOP_PLAY) {
+        return;
+    }
+
+    Xil_ExceptionDisable();
+    tick = loop_tick();
+    while (mode == LOOP_PLAY) {
+        if (rd == length) {
+            due = loop_start + loop_ticks;
+            if ((int) (tick - due) < 0) {
+                break;
+            }
+            loop_start = due;
+            play_tick = due;
+            rd = 0;
+        }
+
+        due = play_tick + loop_delta(arena[rd]);
+        if ((int) (tick - due) < 0) {
+            break;
+        }
+        play_tick = due;
+        fire(arena[rd]);
+        rd += 1;
+    }
+    Xil_ExceptionEnable();
+    return;
+}
+
+bool midi_looper::overflowed() {
+    return overflow;
+}
+
+// Whether an export is still being sent
+bool midi_looper::exporting() {
+    return export_pending || export_step != EXPORT_IDLE;
+}
+
+// Write a big endian value, returns the number of bytes
+static unsigned int smf_put(unsigned char *out, unsigned int x, unsigned int bytes) {
+    for (unsigned int i=bytes; i>0; --i) {
+        out[bytes-i] = (x >> (8*(i-1))) & 0xFF;
+    }
+    return bytes;
+}
+
+// Write a variable length quantity, returns the number of bytes
+static unsigned int smf_vlq(unsigned char *out, unsigned int x) {
+    unsigned int buffer = x & 0x7F;
+    unsigned int bytes = 1;
+
+    while ((x >>= 7) != 0) {
+        buffer = (buffer << 8) | 0x80 | (x & 0x7F);
+        bytes += 1;
+    }
+
+    for (unsigned int i=0; i<bytes; ++i) {
+        out[i] = buffer & 0xFF;
+        buffer >>= 8;
+    }
+    return bytes;
+}
+
+// Walk the next LOOP_EXPORT_RECORDS records of the recording as a
+// standard midi file track into the export buffer, the end of track
+// follows the last record. Returns the bytes written
+unsigned int midi_looper::track_step() {
+    unsigned char *out = export_buffer;
+    unsigned int bytes = 0;
+    unsigned int record;
+    unsigned char status;
+
+    for (unsigned int n=0; n<LOOP_EXPORT_RECORDS && export_rd<length; ++n) {
+        record = arena[export_rd];
+        status = record >> 24;
+        export_rd += 1;
+        export_delta += loop_delta(record);
+        export_elapsed += loop_delta(record);
+
+        if (status == 0 || status >= 0xF0) {
+            continue;
+        }
+
+        bytes += smf_vlq(out+bytes, export_delta);
+        bytes += smf_put(out+bytes, record >> 16, 2);
+        if (loop_data_bytes(status) == 2) {
+            bytes += smf_put(out+bytes, (record >> 8) & 0x7F, 1);
+        }
+        export_delta = 0;
+    }
+
+    // End of track lands on the loop point
+    if (export_rd == length) {
+        bytes += smf_vlq(out+bytes, loop_ticks > export_elapsed ? loop_ticks - export_elapsed + export_delta : export_delta);
+        bytes += smf_put(out+bytes, 0xFF2F00, 3);
+        export_rd += 1;
+    }
+    return bytes;
+}
+
+// One step of sending the recording over the debug uart as a format 0
+// standard midi file. The track is walked once to size it, then again
+// to send it
+void midi_looper::export_next() {
+    unsigned char *out = export_buffer;
+    unsigned int bytes = 0;
+    unsigned int tempo = (unsigned int) ((((unsigned long long) LOOP_DIVISION << LOOP_TICK_SHIFT) * 1000000) / COUNTS_PER_SECOND);
+
+    if (mode == LOOP_RECORD) {
+        export_step = EXPORT_IDLE;
+        return;
+    }
+
+    switch (export_step) {
+        case EXPORT_SIZE :
+            export_bytes += track_step();
+            if (export_rd > length) {
+                export_step = EXPORT_HEADER;
+            }
+            break;
+
+        case EXPORT_HEADER :
+            bytes += smf_put(out+bytes, 0x4D546864, 4);     // MThd
+            bytes += smf_put(out+bytes, 6, 4);
+            bytes += smf_put(out+bytes, 0, 2);
+            bytes += smf_put(out+bytes, 1, 2);
+            bytes += smf_put(out+bytes, LOOP_DIVISION, 2);
+
+            // Tempo chosen so that one midi file tick is one looper tick
+            bytes += smf_put(out+bytes, 0x4D54726B, 4);     // MTrk
+            bytes += smf_put(out+bytes, export_bytes + 7, 4);
+            bytes += smf_vlq(out+bytes, 0);
+            bytes += smf_put(out+bytes, 0xFF5103, 3);
+            bytes += smf_put(out+bytes, tempo, 3);
+
+            export_rd = 0;
+            export_delta = 0;
+            export_elapsed = 0;
+            export_step = EXPORT_TRACK;
+            break;
+
+        case EXPORT_TRACK :
+            bytes = track_step();
+            if (export_rd > length) {
+                export_step = EXPORT_IDLE;
+            }
+            break;
+
+        default :
+            export_step = EXPORT_IDLE;
+            break;
+    }
+
+    for (unsigned int i=0; i<bytes; ++i) {
+        outbyte(out[i]);
+    }
+    return;
+}
@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Records the incoming midi stream into a preallocated arena and
+// plays it back in a loop through its own parser, mixed with live input.
+//
+// Each event is packed into a single 32 bit record:
+//      31:24   status byte, 0x00 marks a delay-only record
+//      23:16   first data byte
+//      15:8    second data byte
+//      7:0     ticks since the previous record
+// A delay-only record holds a 24 bit tick count in 23:0 and is emitted when
+// the gap between two events does not fit in 8 bits. One tick is
+// 2^LOOP_TICK_SHIFT counts of the global timer (~0.79 ms).
+//
+// An export is sent a piece at a time, one step each time the main loop
+// calls service(). The track is first walked LOOP_EXPORT_RECORDS records
+// a step to size it, then the header goes out and the track follows at
+// most LOOP_EXPORT_RECORDS records a step. Starting a recording ends an
+// export still being sent, a new export request starts it again.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_LOOPER_HPP
+#define MYLIB_LOOPER_HPP
+
+#include <stdio.h>
+#include "constants.hpp"
+#include "midi_parser.hpp"
+
+    #define LOOP_EVENTS     65536
+    #define LOOP_TICK_SHIFT 18
+    #define LOOP_DIVISION   480
+
+    // Records walked per export step, and room for the bytes of one step.
+    // An event is at most a 4 byte delta and 3 bytes of message
+    #define LOOP_EXPORT_RECORDS 32
+    #define LOOP_EXPORT_BYTES   (7*LOOP_EXPORT_RECORDS + 7)
+
+    // Looper commands, sent as the value of the LOOPER control change
+    #define LOOP_IDLE       0
+    #define LOOP_RECORD     1
+    #define LOOP_PLAY       2
+    #define LOOP_EXPORT     3
+
+    // Export steps
+    #define EXPORT_IDLE     0
+    #define EXPORT_SIZE     1
+    #define EXPORT_HEADER   2
+    #define EXPORT_TRACK    3
+
+class midi_looper {
+    unsigned int *arena;
+    volatile unsigned int mode;
+    volatile bool export_pending;
+    bool overflow;
+    unsigned int wr;
+    unsigned int current;
+    unsigned int shift;
+    unsigned int length;
+    unsigned int last_tick;
+    unsigned int start_tick;
+    unsigned int loop_ticks;
+    unsigned int rd;
+    unsigned int loop_start;
+    unsigned int play_tick;
+    unsigned int notes_on[NUM_MIDI_CHANNELS][4];
+    unsigned int export_step;
+    unsigned int export_rd;
+    unsigned int export_delta;
+    unsigned int export_elapsed;
+    unsigned int export_bytes;
+    unsigned char export_buffer[LOOP_EXPORT_BYTES];
+    midi_parser parser;
+
+    void open(unsigned char);
+    void finish_recording(unsigned int);
+    void start_playback(unsigned int);
+    void stop_playback();
+    void fire(unsigned int);
+    unsigned int track_step();
+    void export_next();
+
+    public:
+
+        midi_looper();
+
+        void capture(unsigned char);
+        void command(unsigned char);
+        void service();
+        bool exporting();
+        bool overflowed();
+};
+
+#endif
@@ -10,14 +10,23 @@
 #include "xil_printf.h"
 #include "xil_exception.h"
 #include "xscugic.h"
+#include "xscutimer.h"
 #include "xil_io.h"
 #include <stdio.h>
-#include <math.h>
 #include <iostream>
 #include <cstdio>
 #include "constants.hpp"
 #include "linked_list.hpp"
 #include "functions.hpp"
+#include "coalesce.hpp"
+#include "midi_parser.hpp"
+#include "looper.hpp"
+#include "telemetry.hpp"
+#include "recorder.hpp"
+#include "midi_clock.hpp"
+#include "arpeggiator.hpp"
+#include "last_state.hpp"
+#include "zones.hpp"
 
 /*
 General Interrupt Controller definitions and functions, these are necessary
@@ -29,45 +38,77 @@ to use interrupts in the zynq architecture
 */
 #define GIC_DEVICE_ID XPAR_SCUGIC_0_DEVICE_ID
 #define INTC_HANDLER XScuGic_InterruptHandler
-static int GIC_Setup(XScuGic* GicInst, u16 IntrId_1, u16 IntrId_2, u16 IntrId_3);
+static int GIC_Setup(XScuGic* GicInst, const u16 *SynthIntrId, u16 IntrId_2, u16 IntrId_3);
 XScuGic GIC;
 
+/*
+A9 private timer, a one shot alarm for the arpeggiator steps. It counts
+at half the cpu clock, the same rate as the global timer
+    -TIMER_DEVICE_ID    : used to specify the private timer in device
+    -Timer_Setup        : function to initialize the timer
+    -Timer_Alarm        : loads the timer to expire at a global timer time
+    -Timer              : instance of the private timer
+*/
+#define TIMER_DEVICE_ID XPAR_XSCUTIMER_0_DEVICE_ID
+static int Timer_Setup(XScuTimer *TimerInst);
+void Timer_Alarm(XTime due);
+XScuTimer Timer;
+
 /*
 Specific Interrupt definitions and functions unique to this design, one per interrupt
-    -Interrupt ID's : used to address specific interrupts in build
+    -Interrupt ID's : used to address specific interrupts in build, each synth
+                      bank has its own and passes its bank number to the handler
     -Interrupt handler functions : user defined functions to service IRQ
 */
-#define FPGA_SYNTH_INTR_ID XPAR_FABRIC_FM_SYNTH_WRAPPER_0_INTERRUPT_INTR
+static const u16 FPGA_SYNTH_INTR_ID[NUM_BANKS] = {
+    XPAR_FABRIC_FM_SYNTH_WRAPPER_0_INTERRUPT_INTR,
+#if NUM_BANKS > 1
+    XPAR_FABRIC_FM_SYNTH_WRAPPER_1_INTERRUPT_INTR,
+#endif
+};
 #define FPGA_UART_INTR_ID XPAR_FABRIC_AXI_UART_WRAPPER_0_MIDI_INTR_INTR
 #define FPGA_WAVE_SEL_INTR_ID XPAR_FABRIC_DEBOUNCE_PULSE_0_INTERRUPT_INTR
+#define TIMER_INTR_ID XPAR_SCUTIMER_INTR
 void Synth_IRQ_Handler(void *CallbackRef);
 void UART_IRQ_Handler(void *CallbackRef);
 void Wave_Sel_IRQ_Handler(void *CallbackRef);
-
-// Global linked list
-linked_list channels;
+void Timer_IRQ_Handler(void *CallbackRef);
 
 int main(void) {
 
     // Used to verify correct initialization of interrupt controller
     int Status;
-    Status = GIC_Setup(&GIC, FPGA_SYNTH_INTR_ID, FPGA_UART_INTR_ID, FPGA_WAVE_SEL_INTR_ID);
+    Status = Timer_Setup(&Timer);
 
     if (Status != XST_SUCCESS) {
         return XST_FAILURE;
     }
 
-    // Initialize synthesizer
+    // Initialize synthesizer, the boot image and the last state
+    // are in the registers before any interrupt can land
     synth_init(CTRL_INIT);
 
+    Status = GIC_Setup(&GIC, FPGA_SYNTH_INTR_ID, FPGA_UART_INTR_ID, FPGA_WAVE_SEL_INTR_ID);
+
+    if (Status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    arp.set_alarm(Timer_Alarm);
+    telemetry.ready();
+
     // Infinite while loop for
-    // real-time embedded system
-    while(1){}
+    // real-time embedded system. The loop only runs
+    // once the interrupts have drained, so it acts as
+    // the control tick for coalesced controllers
+    while(1){
+        synth_service();
+    }
 
 return 1;
 }
 
-static int GIC_Setup(XScuGic *GicInst, u16 IntrId_1, u16 IntrId_2, u16 IntrId_3) {
+static int GIC_Setup(XScuGic *GicInst, const u16 *SynthIntrId, u16 IntrId_2, u16 IntrId_3) {
     int Status;
 
     XScuGic_Config *IntcConfig;
@@ -84,32 +125,48 @@ static int GIC_Setup(XScuGic *GicInst, u16 IntrId_1, u16 IntrId_2, u16 IntrId_3)
         return XST_FAILURE;
     }
 
-    XScuGic_SetPriorityTriggerType(GicInst, IntrId_1, 0xA0, 0x3);
+    for (unsigned int bank=0; bank<NUM_BANKS; ++bank) {
+        XScuGic_SetPriorityTriggerType(GicInst, SynthIntrId[bank], 0xA0, 0x3);
+    }
     XScuGic_SetPriorityTriggerType(GicInst, IntrId_2, 0xA0, 0x3);
     XScuGic_SetPriorityTriggerType(GicInst, IntrId_3, 0xA0, 0x3);
 
+    //The timer wins over the others when both are pending
+    XScuGic_SetPriorityTriggerType(GicInst, TIMER_INTR_ID, 0x98, 0x3);
+
+    //Connect the interrupt handler to the GIC, once per bank.
+    for (unsigned int bank=0; bank<NUM_BANKS; ++bank) {
+        Status = XScuGic_Connect(GicInst, SynthIntrId[bank], (Xil_ExceptionHandler)Synth_IRQ_Handler, (void *)(UINTPTR) bank);
+        if (Status != XST_SUCCESS) {
+            return Status;
+        }
+    }
+
     //Connect the interrupt handler to the GIC.
-    Status = XScuGic_Connect(GicInst, IntrId_1, (Xil_ExceptionHandler)Synth_IRQ_Handler, 0);
+    Status = XScuGic_Connect(GicInst, IntrId_2, (Xil_ExceptionHandler)UART_IRQ_Handler, 0);
     if (Status != XST_SUCCESS) {
         return Status;
     }
 
     //Connect the interrupt handler to the GIC.
-    Status = XScuGic_Connect(GicInst, IntrId_2, (Xil_ExceptionHandler)UART_IRQ_Handler, 0);
+    Status = XScuGic_Connect(GicInst, IntrId_3, (Xil_ExceptionHandler)Wave_Sel_IRQ_Handler, 0);
     if (Status != XST_SUCCESS) {
         return Status;
     }
 
     //Connect the interrupt handler to the GIC.
-    Status = XScuGic_Connect(GicInst, IntrId_3, (Xil_ExceptionHandler)Wave_Sel_IRQ_Handler, 0);
+    Status = XScuGic_Connect(GicInst, TIMER_INTR_ID, (Xil_ExceptionHandler)Timer_IRQ_Handler, &Timer);
     if (Status != XST_SUCCESS) {
         return Status;
     }
 
     //Enable the interrupt for this specific device.
-    XScuGic_Enable(GicInst, IntrId_1);
+    for (unsigned int bank=0; bank<NUM_BANKS; ++bank) {
+        XScuGic_Enable(GicInst, SynthIntrId[bank]);
+    }
     XScuGic_Enable(GicInst, IntrId_2);
     XScuGic_Enable(GicInst, IntrId_3);
+    XScuGic_Enable(GicInst, TIMER_INTR_ID);
 
     //Initialize the exception table.
     Xil_ExceptionInit();
@@ -123,11 +180,58 @@ static int GIC_Setup(XScuGic *GicInst, u16 IntrId_1, u16 IntrId_2, u16 IntrId_3)
 return XST_SUCCESS;
 }
 
+static int Timer_Setup(XScuTimer *TimerInst) {
+    int Status;
+
+    XScuTimer_Config *TimerConfig;
+
+    //Initialize the private timer, one shot with its interrupt on.
+    TimerConfig = XScuTimer_LookupConfig(TIMER_DEVICE_ID);
+    if (NULL == TimerConfig) {
+        return XST_FAILURE;
+    }
+
+    Status = XScuTimer_CfgInitialize(TimerInst, TimerConfig, TimerConfig->BaseAddr);
+    if (Status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    XScuTimer_DisableAutoReload(TimerInst);
+    XScuTimer_EnableInterrupt(TimerInst);
+
+return XST_SUCCESS;
+}
+
+// Expire at a global timer time, at once if it is already past.
+// Called with the interrupts off, from the handlers or arp.service
+void Timer_Alarm(XTime due) {
+    XTime now;
+    u32 counts = 1;
+
+    XTime_GetTime(&now);
+    if ((long long) (due - now) > 0) {
+        counts = (due - now > 0xFFFFFFFF) ? 0xFFFFFFFF : (u32) (due - now);
+    }
+
+    XScuTimer_Stop(&Timer);
+    XScuTimer_LoadTimer(&Timer, counts);
+    XScuTimer_Start(&Timer);
+}
+
+// IRQ Handling function
+void Timer_IRQ_Handler(void *CallbackRef) {
+    XTime start = telemetry.enter();
+    XScuTimer_ClearInterruptStatus((XScuTimer *) CallbackRef);
+    arp.tick();
+    telemetry.leave(TELEMETRY_IRQ_TIMER, start);
+}
+
 // IRQ Handling function
 void Wave_Sel_IRQ_Handler(void *callbackRef){
     static unsigned char wave_sel = 0;
     unsigned int ctrl_reg = 0;
     unsigned int ctrl_reg_mskd = 0;
+    XTime start = telemetry.enter();
 
     ctrl_reg = Xil_In32(CTRL_REG_ADDR);
     ctrl_reg_mskd = WAVE_SEL_MASK & ctrl_reg;
@@ -140,196 +244,56 @@ void Wave_Sel_IRQ_Handler(void *callbackRef){
     }
 
     switch(wave_sel) {
-        case 0 : Xil_Out32(CTRL_REG_ADDR, ctrl_reg_mskd | SIN_WAVE_MASK);    break;
-        case 1 : Xil_Out32(CTRL_REG_ADDR, ctrl_reg_mskd | SAW_WAVE_MASK);    break;
-        case 2 : Xil_Out32(CTRL_REG_ADDR, ctrl_reg_mskd | SQR_WAVE_MASK);    break;
-        case 3 : Xil_Out32(CTRL_REG_ADDR, ctrl_reg_mskd | TRI_WAVE_MASK);    break;
+        case 0 : synth_broadcast(CTRL_REG_ADDR, ctrl_reg_mskd | SIN_WAVE_MASK);    break;
+        case 1 : synth_broadcast(CTRL_REG_ADDR, ctrl_reg_mskd | SAW_WAVE_MASK);    break;
+        case 2 : synth_broadcast(CTRL_REG_ADDR, ctrl_reg_mskd | SQR_WAVE_MASK);    break;
+        case 3 : synth_broadcast(CTRL_REG_ADDR, ctrl_reg_mskd | TRI_WAVE_MASK);    break;
     }
+    telemetry.leave(TELEMETRY_IRQ_WAVE_SEL, start);
 }
 
-// IRQ Handling function
+// IRQ Handling function, the callback reference is the bank number
 void Synth_IRQ_Handler(void *CallbackRef) {
-    channels.make_available();
+    XTime start = telemetry.enter();
+    channels.make_available((unsigned int)(UINTPTR) CallbackRef);
+    telemetry.leave(TELEMETRY_IRQ_SYNTH, start);
 }
 
-enum states {S_STATUS, S_NOTE_ON, S_NOTE_OFF, S_CONTROL_CHANGE,
-             S_VELOCITY_ON, S_VELOCITY_OFF, S_PATCH, S_VOLUME,
-             S_MOD_TAU, S_RC_TAU, S_PITCH_BEND_LSB, S_PITCH_BEND_MSB,
-             S_MODULATE, S_ERROR};
-
-struct midi_message {
-    enum states curr_state;
-    unsigned char curr_byte;
-};
-
-// unsigned int state = S_STATUS;
-enum states state = S_STATUS;
-
 unsigned char byte_in = 0;
 
-
-unsigned char mode;
-unsigned char status;
-unsigned char on_note;
-unsigned char off_note;
-unsigned char control_change;
-unsigned char velocity;
-unsigned char volume;
-unsigned char mod_byte = 0;
-unsigned char mod_tau_byte;
-unsigned int  pitch_bend_lsb;
-unsigned int  pitch_bend_msb;
-unsigned int  pitch_bend;
-unsigned int  i = 0;
-unsigned char patch = 60;
-struct midi_message midi[40];
-
-// IRQ Handling function
+// IRQ Handling function. The fifo is drained on every
+// interrupt so one entry covers a whole burst of bytes
+// at the high baud rates. The fifo level on entry is
+// the deepest the fifo got since the last interrupt.
+// Real time bytes go straight to the clock tracker and
+// never reach the looper or the parser. Each byte is
+// recorded with the parser states either side of it
 void UART_IRQ_Handler(void *CallbackRef) {
-
-    car_mod notes;
-
-    byte_in = (char) Xil_In32(UART_ADDR);
-        
-    // switch (i) {
-    //     case 0 : midi->byte_1 = byte_in; i = i+1;   break;
-    //     case 1 : midi->byte_2 = byte_in; i = i+1;   break;
-    //     case 2 : midi->byte_3 = byte_in; i = 0;     break;
-    // }
-
-    midi[i].curr_state = state;
-    midi[i].curr_byte = byte_in;
-    if (i<40-1) {
-        i=i+1;
-    }
-    else {
-        i = 0;
+    unsigned int rx_word;
+    unsigned int status;
+    enum states before;
+    XTime start = telemetry.enter();
+
+    status = Xil_In32(UART_STATUS_ADDR);
+    if (UART_FIFO_LEVEL(status) > telemetry.count.uart_fifo_irq_peak) {
+        telemetry.count.uart_fifo_irq_peak = UART_FIFO_LEVEL(status);
     }
-
-    switch (state) {
-        case S_STATUS:
-            status = byte_in;
-            switch (status) {
-                case NOTE_ON : 
-                    state = S_NOTE_ON;
-                    break;
-
-                case NOTE_OFF : 
-                    state = S_NOTE_OFF;
-                    break;
-
-                case CONTROL_CHANGE :
-                    state = S_CONTROL_CHANGE;
-                    break;
-
-                case PITCH_BEND :
-                    state = S_PITCH_BEND_LSB;
-                    break;
-
-                default :
-                    state = S_ERROR;
-                    break;
-            }
-            break;
-
-
-        case S_ERROR:
-            state = S_STATUS;
-            break;
-
-        case S_NOTE_ON:
-            on_note = byte_in;
-            state = S_VELOCITY_ON;
-            break;
-
-
-        case S_NOTE_OFF:
-            off_note = byte_in;
-            notes = decode_note(off_note, patch, mod_byte);
-            if (notes.index != 255) {
-                channels.note_off(notes);
-            }
-            state = S_VELOCITY_OFF;
-            break;
-
-
-        case S_CONTROL_CHANGE:
-            control_change = byte_in;
-            switch (control_change) {
-                case PATCH    : state = S_PATCH;    break;
-                case RC_TAU   : state = S_RC_TAU;   break;
-                case MOD_AMP  : state = S_MOD_TAU;  break;
-                case VOLUME   : state = S_VOLUME;   break;
-                case MODULATE : state = S_MODULATE; break;
-                default       : state = S_ERROR;    break;
-            }
-            break;
-
-
-        case S_PATCH:
-            patch = byte_in;
-            channels.toggle_modulator(notes, patch);
-            state = S_STATUS;
-            break;
-
-
-        case S_VOLUME:
-            volume = byte_in;
-            decode_volume(volume);
-            state = S_STATUS;
-            break;
-
-
-        case S_RC_TAU:
-            mod_byte = byte_in;
-            decode_tau(mod_byte);
-            state = S_STATUS;
-            break;
-
-
-        case S_MOD_TAU:
-            mod_tau_byte = byte_in;
-            decode_mod_tau(mod_tau_byte);
-            state = S_STATUS;
-            break;
-
-
-        case S_MODULATE:
-            modulate(byte_in);
-            state = S_STATUS;
-            break;
-
-
-        case S_VELOCITY_ON:
-            velocity = byte_in;
-            notes = decode_note(on_note, patch, mod_byte);
-            if (notes.index != 255) {
-                channels.note_on(notes, velocity);
-            }
-            state = S_STATUS;
-            break;
-
-
-        case S_VELOCITY_OFF:
-            velocity = byte_in;
-            state = S_STATUS;
-            break;
-
-
-        case S_PITCH_BEND_LSB:
-            pitch_bend_lsb = (unsigned int) byte_in;
-            state = S_PITCH_BEND_MSB;
-            break;
-
-        case S_PITCH_BEND_MSB:
-            pitch_bend_msb = (unsigned int) byte_in;
-            pitch_bend = (pitch_bend_msb << 7) | pitch_bend_lsb;
-            channels.bend_pitch(pitch_bend);
-            state = S_STATUS;
-            break;
+    telemetry.count.uart_overruns = UART_OVERRUNS(status);
+
+    rx_word = Xil_In32(UART_ADDR);
+    while (rx_word & UART_DATA_VALID) {
+        byte_in = (char) rx_word;
+        before = live_parser.get_state();
+
+        if (byte_in >= MIDI_CLOCK) {
+            tempo.realtime(byte_in, start);
+        }
+        else {
+            looper.capture(byte_in);
+            live_parser.parse(byte_in);
+        }
+        recorder.log(RECORDER_MIDI, byte_in, before | (live_parser.get_state() << 8));
+        rx_word = Xil_In32(UART_ADDR);
     }
-
+    telemetry.leave(TELEMETRY_IRQ_UART, start);
 }
-
-
-
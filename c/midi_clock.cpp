@@ -0,0 +1,119 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Clock tracking loop and transport of the midi clock, see
+// midi_clock.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "midi_clock.hpp"
+#include "arpeggiator.hpp"
+
+clock_tracker tempo;
+
+// Fold one clock at time t into the loop. A clock that is far off the
+// prediction, or the first after a quiet spell, relocks instead. Start
+// makes the clock number 0, otherwise a relock keeps the number the
+// clock would have had running on the old tempo. The interval since the
+// last clock is split over the periods it spans, so a lost clock byte
+// does not relock on twice the period
+void clock_tracker::follow(XTime t) {
+    long long e = (long long) (t - next);
+    long long p = period >> CLOCK_FRAC;
+    XTime gap = t - last;
+    XTime spans = (gap + p/2) / p;
+    bool locked = external && gap <= (XTime) CLOCK_TIMEOUT_MS * (COUNTS_PER_SECOND / 1000);
+    unsigned int number = index;
+
+    if (locked && !start_pending && e > -p/2 && e < p/2) {
+        next = next + p + e / (1 << CLOCK_PHASE_SHIFT);
+        period = period + e * (1 << (CLOCK_FRAC - CLOCK_PERIOD_SHIFT));
+    }
+    else {
+        if (spans == 0) {
+            spans = 1;
+        }
+        if (locked && gap / spans >= CLOCK_PERIOD_MIN && gap / spans <= CLOCK_PERIOD_MAX) {
+            period = (long long) (gap / spans) << CLOCK_FRAC;
+        }
+        if (!start_pending) {
+            number = index + (int) ((e + ((e < 0) ? -p/2 : p/2)) / p);
+        }
+        next = t + (period >> CLOCK_FRAC);
+    }
+
+    index = number+1;
+    last = t;
+    external = true;
+    start_pending = false;
+    return;
+}
+
+// Real time byte from the uart fast path, t is when it arrived.
+// Without an external clock start counts from now
+void clock_tracker::realtime(unsigned char x, XTime t) {
+    switch (x) {
+        case MIDI_CLOCK :
+            follow(t);
+            arp.retime();
+            break;
+
+        case MIDI_START :
+            running = true;
+            start_pending = true;
+            next = t;
+            index = 0;
+            arp.start();
+            break;
+
+        case MIDI_CONTINUE :
+            running = true;
+            arp.resume();
+            break;
+
+        case MIDI_STOP :
+            running = false;
+            arp.stop();
+            break;
+
+        default :
+            break;
+    }
+    return;
+}
+
+// Predicted time of a clock number, numbers behind the
+// last clock come out in the past
+XTime clock_tracker::due(unsigned int number) {
+    return next + ((long long) (int) (number - index) * period >> CLOCK_FRAC);
+}
+
+// Number of the first clock not yet due
+unsigned int clock_tracker::next_clock() {
+    XTime now;
+    long long p = period >> CLOCK_FRAC;
+
+    XTime_GetTime(&now);
+    if ((long long) (now - next) <= 0) {
+        return index;
+    }
+    return index + (unsigned int) ((now - next + p - 1) / p);
+}
+
+// False once stopped, and between a start and the clock it waits for
+bool clock_tracker::is_running() {
+    XTime now;
+
+    XTime_GetTime(&now);
+    if (external && now - last > (XTime) CLOCK_TIMEOUT_MS * (COUNTS_PER_SECOND / 1000)) {
+        external = false;
+    }
+    return running && !(start_pending && external);
+}
+
+// Tracked tempo in thousandths of a beat per minute
+unsigned int clock_tracker::tempo_mbpm() {
+    return (unsigned int) ((u64) COUNTS_PER_SECOND * 60000 / (CLOCK_PPQN * (u64) (period >> CLOCK_FRAC)));
+}
@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Tempo of the midi clock, 24 clocks to the quarter note. Real
+// time bytes are taken off the uart ahead of the looper and the parser, so a
+// clock landing between the bytes of a message changes nothing. Each clock
+// is time stamped and fed to a second order loop that tracks the time of the
+// next clock and the clock period in global timer counts:
+//
+//      e       = t - next              error against the predicted time
+//      next    = next + period + e/8
+//      period  = period + e/128
+//
+// The gains are sqrt(2)w and w^2 for w = 1/8 sqrt(1/2), a damping of 0.7
+// and a bandwidth of ~1.4 % of the clock rate, so byte jitter of the uart
+// is smoothed out over a couple of beats while tempo changes are followed
+// within a bar. An error of more than half a period (a missed clock or a new
+// tempo) relocks on the last interval, split over the periods it spans.
+//
+// Without an external clock, or once it has been quiet for CLOCK_TIMEOUT_MS,
+// the last tempo keeps running from the predicted clocks, CLOCK_BPM_INIT at
+// power up. Start resets the clock count so the next clock is number 0,
+// stop holds the transport until start or continue.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_MIDI_CLOCK_HPP
+#define MYLIB_MIDI_CLOCK_HPP
+
+#include <stdio.h>
+#include "xil_types.h"
+#include "xtime_l.h"
+#include "constants.hpp"
+
+    #define CLOCK_PPQN          24
+    #define CLOCK_BPM_INIT      120
+    #define CLOCK_TIMEOUT_MS    500
+
+    // Fraction bits of the period
+    #define CLOCK_FRAC          16
+
+    // Loop gains as shifts, b = 1/8 and c = 1/128
+    #define CLOCK_PHASE_SHIFT   3
+    #define CLOCK_PERIOD_SHIFT  7
+
+    // Relock range, 20 to 300 bpm
+    #define CLOCK_PERIOD_MIN    ((u64) COUNTS_PER_SECOND * 60 / (300 * CLOCK_PPQN))
+    #define CLOCK_PERIOD_MAX    ((u64) COUNTS_PER_SECOND * 60 / (20 * CLOCK_PPQN))
+
+class clock_tracker {
+    XTime next;
+    long long period;
+    XTime last;
+    unsigned int index;
+    bool external;
+    bool running;
+    bool start_pending;
+
+    void follow(XTime);
+
+    public:
+
+        clock_tracker() {
+            next = 0;
+            period = (long long) ((u64) COUNTS_PER_SECOND * 60 / (CLOCK_BPM_INIT * CLOCK_PPQN)) << CLOCK_FRAC;
+            last = 0;
+            index = 0;
+            external = false;
+            running = true;
+            start_pending = false;
+        }
+
+        void realtime(unsigned char, XTime);
+        XTime due(unsigned int);
+        unsigned int next_clock();
+        bool is_running();
+        unsigned int tempo_mbpm();
+};
+
+    extern clock_tracker tempo;
+
+#endif
@@ -0,0 +1,284 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Midi state machine, one call to parse per byte, see
+// midi_parser.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "xil_printf.h"
+#include "xil_io.h"
+#include "midi_parser.hpp"
+#include "functions.hpp"
+#include "looper.hpp"
+#include "telemetry.hpp"
+#include "arpeggiator.hpp"
+#include "zones.hpp"
+
+// Current state, recorded alongside each byte for debugging
+enum states midi_parser::get_state() {
+    return state;
+}
+
+// Advance the state machine by one midi byte
+void midi_parser::parse(unsigned char byte_in) {
+
+    unsigned char volume;
+    unsigned char mod_tau_byte;
+    unsigned int  pitch_bend_msb;
+    unsigned int  pitch_bend;
+
+    // Real time bytes go to the clock tracker ahead of the parser,
+    // any that get here are dropped so the state is left alone
+    if (byte_in >= MIDI_CLOCK) {
+        return;
+    }
+
+    // Sysex data bytes skip the state machine
+    if (state == S_SYSEX && byte_in < 0x80) {
+        sysex.receive(byte_in);
+        return;
+    }
+
+    switch (state) {
+        case S_STATUS:
+            // Running status, a data byte repeats the last channel
+            // message. Hosts use it to cut a third of the note bytes
+            if (byte_in < 0x80) {
+                if (status >= 0x80 && status < 0xF0) {
+                    parse(status);
+                    parse(byte_in);
+                }
+                break;
+            }
+
+            // Channel messages are taken on every channel, the
+            // zones decide which of them play
+            status = byte_in;
+            channel = status & 0x0F;
+            switch ((status < 0xF0) ? (status & 0xF0) : status) {
+                case NOTE_ON : 
+                    state = S_NOTE_ON;
+                    break;
+
+                case NOTE_OFF : 
+                    state = S_NOTE_OFF;
+                    break;
+
+                case CONTROL_CHANGE :
+                    state = S_CONTROL_CHANGE;
+                    break;
+
+                case PITCH_BEND :
+                    state = S_PITCH_BEND_LSB;
+                    break;
+
+                case POLYPHONIC_AFTERTOUCH :
+                    state = S_POLY_PRESSURE_NOTE;
+                    break;
+
+                case CHANNEL_AFTERTOUCH :
+                    state = S_CHANNEL_PRESSURE;
+                    break;
+
+                case PROGRAM_CHANGE :
+                    state = S_PROGRAM;
+                    break;
+
+                case SYSEX_START :
+                    sysex.start();
+                    state = S_SYSEX;
+                    break;
+
+                default :
+                    telemetry.count.parser_errors += 1;
+                    state = S_ERROR;
+                    break;
+            }
+            break;
+
+
+        case S_ERROR:
+            state = S_STATUS;
+            break;
+
+
+        case S_SYSEX:
+            state = S_STATUS;
+            if (byte_in == SYSEX_END) {
+                sysex.end();
+            }
+            // Any other status byte ends the sysex and starts the next
+            // message, a note off after a broken dump must not be lost
+            else {
+                sysex.abort();
+                parse(byte_in);
+            }
+            break;
+
+
+        case S_PROGRAM:
+            load_preset(byte_in);
+            state = S_STATUS;
+            break;
+
+        case S_NOTE_ON:
+            on_note = byte_in;
+            state = S_VELOCITY_ON;
+            break;
+
+
+        case S_NOTE_OFF:
+            off_note = byte_in;
+            if (!arp.release(off_note)) {
+                zones.note_off(off_note, channel);
+            }
+            state = S_VELOCITY_OFF;
+            break;
+
+
+        case S_CONTROL_CHANGE:
+            control_change = byte_in;
+            switch (control_change) {
+                case PATCH       : state = S_PATCH;    break;
+                case RC_TAU      : state = S_RC_TAU;   break;
+                case MOD_AMP     : state = S_MOD_TAU;  break;
+                case VOLUME      : state = S_VOLUME;   break;
+                case MODULATE    : state = S_MODULATE; break;
+                case UNISON      : state = S_UNISON;   break;
+                case LOOPER      : state = S_LOOPER;   break;
+                case BANKS       : state = S_BANKS;    break;
+                case ARPEGGIATOR : state = S_ARP_MODE; break;
+                case ARP_RATE    : state = S_ARP_RATE; break;
+                default          :
+                    telemetry.count.parser_errors += 1;
+                    state = S_ERROR;
+                    break;
+            }
+            break;
+
+
+        case S_PATCH:
+            patch = byte_in;
+            channels.toggle_modulator(patch);
+            state = S_STATUS;
+            break;
+
+
+        case S_VOLUME:
+            volume = byte_in;
+            controls.post_volume(channel, volume);
+            state = S_STATUS;
+            break;
+
+
+        case S_RC_TAU:
+            mod_byte = byte_in;
+            decode_tau(mod_byte);
+            state = S_STATUS;
+            break;
+
+
+        case S_MOD_TAU:
+            mod_tau_byte = byte_in;
+            decode_mod_tau(mod_tau_byte);
+            state = S_STATUS;
+            break;
+
+
+        case S_MODULATE:
+            modulate();
+            state = S_STATUS;
+            break;
+
+
+        case S_UNISON:
+            channels.set_unison(byte_in);
+            state = S_STATUS;
+            break;
+
+
+        case S_LOOPER:
+            looper.command(byte_in);
+            state = S_STATUS;
+            break;
+
+
+        case S_BANKS:
+            channels.set_banks(byte_in);
+            state = S_STATUS;
+            break;
+
+
+        case S_ARP_MODE:
+            arp.set_mode(byte_in);
+            state = S_STATUS;
+            break;
+
+
+        case S_ARP_RATE:
+            arp.set_rate(byte_in);
+            state = S_STATUS;
+            break;
+
+
+        case S_VELOCITY_ON:
+            velocity = byte_in;
+            // A note on with zero velocity is a note off,
+            // which is how running status streams end notes.
+            // With the arpeggiator on, notes are only held
+            if (velocity == 0) {
+                if (!arp.release(on_note)) {
+                    zones.note_off(on_note, channel);
+                }
+            }
+            else if (arp.enabled()) {
+                arp.hold(on_note, channel, velocity);
+            }
+            else {
+                zones.note_on(on_note, channel, velocity);
+            }
+            state = S_STATUS;
+            break;
+
+
+        case S_VELOCITY_OFF:
+            velocity = byte_in;
+            state = S_STATUS;
+            break;
+
+
+        case S_PITCH_BEND_LSB:
+            pitch_bend_lsb = (unsigned int) byte_in;
+            state = S_PITCH_BEND_MSB;
+            break;
+
+        case S_PITCH_BEND_MSB:
+            pitch_bend_msb = (unsigned int) byte_in;
+            pitch_bend = (pitch_bend_msb << 7) | pitch_bend_lsb;
+            controls.post_bend(channel, pitch_bend);
+            state = S_STATUS;
+            break;
+
+
+        case S_POLY_PRESSURE_NOTE:
+            pressure_note = byte_in;
+            state = S_POLY_PRESSURE;
+            break;
+
+
+        case S_POLY_PRESSURE:
+            controls.post_poly_pressure(channel, pressure_note, byte_in);
+            state = S_STATUS;
+            break;
+
+
+        case S_CHANNEL_PRESSURE:
+            controls.post_pressure(channel, byte_in);
+            state = S_STATUS;
+            break;
+    }
+
+}
@@ -0,0 +1,68 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Midi state machine. One parser is created for every source of
+// midi bytes so that interleaved streams cannot corrupt each other's state.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_MIDI_PARSER_HPP
+#define MYLIB_MIDI_PARSER_HPP
+
+#include <stdio.h>
+#include "constants.hpp"
+#include "linked_list.hpp"
+#include "coalesce.hpp"
+#include "sysex.hpp"
+
+    enum states {S_STATUS, S_NOTE_ON, S_NOTE_OFF, S_CONTROL_CHANGE,
+                 S_VELOCITY_ON, S_VELOCITY_OFF, S_PATCH, S_VOLUME,
+                 S_MOD_TAU, S_RC_TAU, S_PITCH_BEND_LSB, S_PITCH_BEND_MSB,
+                 S_MODULATE, S_POLY_PRESSURE_NOTE, S_POLY_PRESSURE,
+                 S_CHANNEL_PRESSURE, S_UNISON, S_LOOPER, S_BANKS, S_PROGRAM,
+                 S_ARP_MODE, S_ARP_RATE, S_SYSEX, S_ERROR};
+
+    // Synthesizer state shared by every parser
+    extern linked_list channels;
+    extern coalescer controls;
+    extern unsigned char patch;
+    extern unsigned char mod_byte;
+    extern sysex_decoder sysex;
+
+    class midi_looper;
+    extern midi_looper looper;
+
+    class midi_parser;
+    extern midi_parser live_parser;
+
+class midi_parser {
+    enum states state;
+    unsigned char status;
+    unsigned char channel;
+    unsigned char on_note;
+    unsigned char off_note;
+    unsigned char control_change;
+    unsigned char velocity;
+    unsigned char pressure_note;
+    unsigned int  pitch_bend_lsb;
+
+    public:
+
+        midi_parser() {
+            state = S_STATUS;
+            status = 0;
+            channel = 0;
+            on_note = 0;
+            off_note = 0;
+            control_change = 0;
+            velocity = 0;
+            pressure_note = 0;
+            pitch_bend_lsb = 0;
+        }
+
+        enum states get_state();
+        void parse(unsigned char);
+};
+
+#endif
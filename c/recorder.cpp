@@ -0,0 +1,95 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Mapping and start up of the flight recorder ring, see recorder.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "recorder.hpp"
+
+#ifdef RECORDER_ADDR
+#include "xil_mmu.h"
+#include "xil_cache.h"
+#else
+static recorder_region hosted;
+#endif
+
+// Records logged before init, before the region is mapped
+static recorder_record scratch;
+static volatile u32 scratch_head;
+
+flight_recorder recorder;
+
+flight_recorder::flight_recorder() {
+    region = NULL;
+    ring = &scratch;
+    head = &scratch_head;
+    mask = 0;
+    next = 0;
+    high = 0;
+}
+
+// Map the region and pick up where the last run left off, a region
+// that was never written or has another layout is cleared first.
+// Called before anything else in synth_init
+void flight_recorder::init() {
+    XTime now;
+    u32 kept;
+
+#ifdef RECORDER_ADDR
+    region = (recorder_region *) RECORDER_ADDR;
+    Xil_DCacheFlushRange(RECORDER_ADDR, sizeof(recorder_region));
+    Xil_SetTlbAttributes(RECORDER_ADDR, RECORDER_ATTR);
+#else
+    region = &hosted;
+#endif
+
+    if (region->magic != RECORDER_MAGIC || region->version != RECORDER_VERSION || region->records != RECORDER_RECORDS) {
+        for (unsigned int n=0; n<RECORDER_RECORDS; ++n) {
+            region->ring[n].tag = 0;
+        }
+        region->head = 0;
+        region->boots = 0;
+        region->version = RECORDER_VERSION;
+        region->records = RECORDER_RECORDS;
+        region->magic = RECORDER_MAGIC;
+    }
+
+    region->boots = region->boots+1;
+    kept = region->head;
+    next = kept;
+    ring = region->ring;
+    head = &region->head;
+    mask = RECORDER_MASK;
+
+    XTime_GetTime(&now);
+    high = (u32) (now >> 32);
+    log(RECORDER_BOOT, region->boots, kept);
+    log(RECORDER_TIME, high, (u32) now);
+    return;
+}
+
+// Log the timer high word each time it moves, the low words of the
+// records in between are unwrapped against it
+void flight_recorder::service() {
+    XTime now;
+
+    XTime_GetTime(&now);
+    if ((u32) (now >> 32) != high) {
+        high = (u32) (now >> 32);
+        log(RECORDER_TIME, high, (u32) now);
+    }
+    return;
+}
+
+// The whole region for a dump, records keep arriving while it is sent
+// and the decoder drops any slot whose number does not fit the head
+unsigned char *flight_recorder::data() {
+    return (unsigned char *) region;
+}
+
+unsigned int flight_recorder::size() {
+    return (region == NULL) ? 0 : sizeof(recorder_region);
+}
@@ -0,0 +1,154 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Flight recorder of the firmware. Every midi byte with the
+// parser state it moved the parser between, every voice allocation decision,
+// every arpeggiator step and every synth register write is logged to a ring
+// of fixed size records, always on. tools/recorder rebuilds the timeline
+// from a sysex dump of SYSEX_TARGET_RECORDER.
+//
+// A record is four stores to uncached memory behind a single read of the
+// global timer and one ldrex/strex add of the record count, so the handlers
+// and the main loop log without a lock. The head is moved with a compare and
+// swap that only takes it forward, a record finished under a later one
+// never winds it back. The ring sits in a DDR section kept
+// out of the linker script and is never cleared, after a soft reset init()
+// finds the magic word and carries on past the records of the last run.
+//
+// Time stamps are the low word of the global timer, which wraps every ~13 s
+// at 333 MHz. service() logs the high word each time it moves so the
+// decoder can unwrap them.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_RECORDER_HPP
+#define MYLIB_RECORDER_HPP
+
+#include <stdio.h>
+#include "xparameters.h"
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xtime_l.h"
+
+    #define RECORDER_MAGIC      0x464C5452
+    #define RECORDER_VERSION    1
+
+    // Records in the ring, a power of two
+    #ifndef RECORDER_RECORDS
+        #define RECORDER_RECORDS    8192
+    #endif
+    #define RECORDER_MASK       (RECORDER_RECORDS-1)
+
+    //Last 1 MB section of the CPU0 DDR, mapped normal uncached so a record
+    //is in DDR the moment it is written. Hosted builds use a plain array
+    #ifdef XPAR_PS7_DDR_0_S_AXI_BASEADDR
+        #define RECORDER_ADDR   0x0FF00000
+    #endif
+    #define RECORDER_ATTR       0x14DE2
+
+    //Record types
+    #define RECORDER_BOOT       0x01    // a : run number since the ring was cleared, b : records before this run
+    #define RECORDER_TIME       0x02    // a : global timer high word, b : low word
+    #define RECORDER_RESTORE    0x03    // a : sequence of the last state restored, 0 if none, b : next slot
+    #define RECORDER_SAVE       0x04    // a : sequence of the last state written, b : its slot
+    #define RECORDER_MIDI       0x10    // a : midi byte, b : parser state before | state after << 8
+    #define RECORDER_WRITE      0x20    // a : synth register address, b : value
+    #define RECORDER_NOTE_ON    0x30    // a : key | midi channel << 8, b : group | channels << 8 | first bank << 16 | first channel << 24
+    #define RECORDER_RETRIGGER  0x31    // a : key | midi channel << 8, b : group taken back from its release
+    #define RECORDER_NOTE_OFF   0x32    // a : key | midi channel << 8, b : group, 0 for a software voice, RECORDER_NOT_HELD if no held group plays it
+    #define RECORDER_STEAL      0x33    // a : group | bank << 8 | channel << 16, b : level | held << 31
+    #define RECORDER_DROP       0x34    // a : carrier word
+    #define RECORDER_SPILL      0x35    // a : carrier word, note went to a software voice
+    #define RECORDER_FREE       0x36    // a : bank, b : channel back in the free pool
+    #define RECORDER_ARP        0x37    // a : midi note of an arpeggiator step, b : global timer counts late
+
+    #define RECORDER_NOT_HELD   0x100
+
+    /*
+    One record, all words little endian
+        -time   : global timer low word
+        -tag    : type in 7:0, record number in 31:8
+        -a      : first argument of the type
+        -b      : second argument of the type
+    */
+    struct recorder_record {
+        u32 time;
+        u32 tag;
+        u32 a;
+        u32 b;
+    };
+
+    /*
+    The reserved region, dumped as one block
+        -magic      : RECORDER_MAGIC once the ring has been cleared
+        -version    : RECORDER_VERSION, a different layout clears the ring
+        -records    : RECORDER_RECORDS
+        -boots      : runs logged since the ring was cleared
+        -head       : records written since the ring was cleared, the newest is head-1
+        -ring       : slot n & RECORDER_MASK holds record n
+    */
+    struct recorder_region {
+        volatile u32 magic;
+        volatile u32 version;
+        volatile u32 records;
+        volatile u32 boots;
+        volatile u32 head;
+        recorder_record ring[RECORDER_RECORDS];
+    };
+
+    // Global timer low word, one read of the timer on target
+    static inline u32 recorder_time() {
+    #ifdef GLOBAL_TMR_BASEADDR
+        return Xil_In32(GLOBAL_TMR_BASEADDR + GTIMER_COUNTER_LOWER_OFFSET);
+    #else
+        XTime now;
+        XTime_GetTime(&now);
+        return (u32) now;
+    #endif
+    }
+
+class flight_recorder {
+    recorder_region *region;
+    recorder_record *ring;
+    volatile u32 *head;
+    u32 mask;
+    u32 next;
+    u32 high;
+
+    public:
+
+        // Until init() every record lands in one scratch slot
+        flight_recorder();
+
+        // Log one record, safe from the handlers and the main loop
+        void log(u32 type, u32 a, u32 b) {
+            u32 n = __atomic_fetch_add(&next, 1, __ATOMIC_RELAXED);
+            recorder_record *r = &ring[n & mask];
+            u32 h;
+
+            r->time = recorder_time();
+            r->tag = type | (n << 8);
+            r->a = a;
+            r->b = b;
+
+            // A handler that logs between the add and here stores a later
+            // head first, the head only ever moves forward
+            h = *head;
+            while ((s32) (n+1 - h) > 0) {
+                if (__atomic_compare_exchange_n(head, &h, n+1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    break;
+                }
+            }
+            return;
+        }
+
+        void init();
+        void service();
+        unsigned char *data();
+        unsigned int size();
+};
+
+    extern flight_recorder recorder;
+
+#endif
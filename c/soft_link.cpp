@@ -0,0 +1,121 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Software voice allocation and the mailbox ring on this core, see
+// soft_link.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "xil_io.h"
+#include "soft_link.hpp"
+
+#ifdef SOFT_MAILBOX_ADDR
+#include "xil_mmu.h"
+#include "xpseudo_asm.h"
+#endif
+
+soft_pool soft;
+
+// Clear the mailbox and start the second core at its image in DDR,
+// it sets alive once its first block is on the way
+void soft_pool::init() {
+#ifdef SOFT_MAILBOX_ADDR
+    box = (soft_mailbox *) SOFT_MAILBOX_ADDR;
+    Xil_SetTlbAttributes(SOFT_MAILBOX_ADDR, SOFT_MAILBOX_ATTR);
+    box->alive = 0;
+    box->head = 0;
+    box->tail = 0;
+    box->busy = 0;
+    box->blocks = 0;
+    box->late = 0;
+
+    Xil_Out32(SOFT_CPU1_VECTOR, SOFT_CPU1_START);
+    dmb();
+    sev();
+#endif
+    return;
+}
+
+bool soft_pool::ready() {
+    return box != NULL && box->alive == SOFT_ALIVE;
+}
+
+// Voice holding the note id, SOFT_VOICES if none
+unsigned int soft_pool::find(unsigned int id) {
+    for (unsigned int v=0; v<SOFT_VOICES; ++v) {
+        if (note[v] == id) {
+            return v;
+        }
+    }
+    return SOFT_VOICES;
+}
+
+// Queue a command, false if it would leave fewer than spare slots free
+bool soft_pool::post(unsigned char type, unsigned int v, unsigned int car, unsigned int mod, unsigned int velocity, unsigned int spare) {
+    unsigned int head = box->head;
+    soft_command *cmd = &box->ring[head % SOFT_RING];
+
+    if (head - box->tail + spare >= SOFT_RING) {
+        return false;
+    }
+    cmd->type = type;
+    cmd->voice = (unsigned char) v;
+    cmd->car = car;
+    cmd->mod = mod;
+    cmd->velocity = velocity;
+#ifdef SOFT_MAILBOX_ADDR
+    dmb();
+#endif
+    box->head = head+1;
+    return true;
+}
+
+bool soft_pool::holds(unsigned int id) {
+    return id != 0 && find(id) != SOFT_VOICES;
+}
+
+// Start the note on a software voice. A voice that has finished its
+// release is taken first, then one that is still releasing. Returns
+// false if the second core is not running or every voice is held.
+// A note on keeps a slot free for the note off of every voice, so a
+// full ring only ever turns away note ons and a note off always posts
+bool soft_pool::note_on(unsigned int id, unsigned int car, unsigned int mod, unsigned int velocity) {
+    unsigned int v;
+    unsigned int busy;
+
+    if (!ready() || id == 0) {
+        return false;
+    }
+
+    v = find(id);
+    busy = box->busy;
+    for (unsigned int i=0; i<SOFT_VOICES && v == SOFT_VOICES; ++i) {
+        if (note[i] == 0 && ((busy >> i) & 1) == 0) {
+            v = i;
+        }
+    }
+    for (unsigned int i=0; i<SOFT_VOICES && v == SOFT_VOICES; ++i) {
+        if (note[i] == 0) {
+            v = i;
+        }
+    }
+    if (v == SOFT_VOICES || !post(SOFT_NOTE_ON, v, car, mod, velocity, SOFT_VOICES)) {
+        return false;
+    }
+    note[v] = id;
+    return true;
+}
+
+// Release the software voice playing the note id, false if none is
+bool soft_pool::note_off(unsigned int id) {
+    unsigned int v = id == 0 ? SOFT_VOICES : find(id);
+
+    if (v == SOFT_VOICES) {
+        return false;
+    }
+    note[v] = 0;
+    post(SOFT_NOTE_OFF, v, 0, 0, 0, 0);
+    return true;
+}
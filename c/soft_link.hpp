@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: What the two cores share for the software voices. This core
+// keeps the allocation and posts note commands to a ring in on chip memory,
+// the second core (cpu1/) renders them into the mix stream and reports which
+// voices are still sounding. The voices only exist when the block design has
+// the mix DMA, otherwise ready() is always false and every note stays in the
+// fabric.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_SOFT_LINK_HPP
+#define MYLIB_SOFT_LINK_HPP
+
+#include <stdio.h>
+#include "xparameters.h"
+
+    #define SOFT_VOICES     16
+    #define SOFT_RING       64
+
+    //Top of OCM holds the mailbox, both cores map it normal uncached. CPU1
+    //runs from its own DDR region, see scripts/build_vitis.tcl
+    #ifdef XPAR_AXI_DMA_0_BASEADDR
+        #define SOFT_MAILBOX_ADDR   0xFFFF0000
+    #endif
+    #define SOFT_MAILBOX_ATTR   0x14DE2
+    #define SOFT_CPU1_VECTOR    0xFFFFFFF0
+    #define SOFT_CPU1_START     0x10000000
+    #define SOFT_ALIVE          0x534F4654
+
+    //Commands
+    #define SOFT_NOTE_ON        1
+    #define SOFT_NOTE_OFF       2
+
+    /*
+    One note command for the second core
+        -type       : SOFT_NOTE_ON or SOFT_NOTE_OFF
+        -voice      : software voice, 0 to SOFT_VOICES-1
+        -car        : carrier tuning word
+        -mod        : modulator tuning word
+        -velocity   : velocity register word, attack level in 31:16
+    */
+    struct soft_command {
+        unsigned char type;
+        unsigned char voice;
+        unsigned int car;
+        unsigned int mod;
+        unsigned int velocity;
+    };
+
+    /*
+    Mailbox, each field has a single writer
+        -alive      : SOFT_ALIVE once the second core is streaming (CPU1)
+        -head       : commands posted, free running (CPU0)
+        -tail       : commands taken, free running (CPU1)
+        -busy       : voices still sounding, one bit each (CPU1)
+        -blocks     : blocks streamed to the mix input (CPU1)
+        -late       : blocks that found the DMA already idle, the FIFO may have run dry (CPU1)
+    */
+    struct soft_mailbox {
+        volatile unsigned int alive;
+        volatile unsigned int head;
+        volatile unsigned int tail;
+        volatile unsigned int busy;
+        volatile unsigned int blocks;
+        volatile unsigned int late;
+        soft_command ring[SOFT_RING];
+    };
+
+class soft_pool {
+    soft_mailbox *box;
+    // Id of the note each voice holds, VOICE_ID of the key, 0 when free
+    unsigned int note[SOFT_VOICES];
+
+    unsigned int find(unsigned int);
+    bool post(unsigned char, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int);
+
+    public:
+
+        soft_pool() {
+            box = NULL;
+            for (unsigned int i=0; i<SOFT_VOICES; ++i) {
+                note[i] = 0;
+            }
+        }
+
+        void init();
+        bool ready();
+        bool holds(unsigned int);
+        bool note_on(unsigned int, unsigned int, unsigned int, unsigned int);
+        bool note_off(unsigned int);
+};
+
+    extern soft_pool soft;
+
+#endif
@@ -0,0 +1,37 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Non volatile storage for the firmware, a small area at the top
+// of the QSPI boot flash on target (storage_qspi.cpp) and a plain file in the
+// Linux build (linux/storage_file.cpp). Offsets are from the start of the area.
+//
+// The area keeps NOR flash rules on both. Erase sets a whole sector to 0xFF,
+// program can only clear bits and must stay within one page. Both return as
+// soon as the flash has the command, storage_busy is true until it is done,
+// so the main loop is never held for the length of an erase.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_STORAGE_HPP
+#define MYLIB_STORAGE_HPP
+
+#include <stdio.h>
+#include "xil_types.h"
+
+    #define STORAGE_PAGE_BYTES      256
+    #define STORAGE_SECTOR_BYTES    0x10000
+    #define STORAGE_SECTORS         2
+    #define STORAGE_BYTES           (STORAGE_SECTORS * STORAGE_SECTOR_BYTES)
+
+    // Start of the area in the 16 MB flash, the last two sectors. The boot
+    // image is written from offset 0 and stays well clear of it
+    #define STORAGE_FLASH_OFFSET    (0x01000000 - STORAGE_BYTES)
+
+    bool storage_init();
+    bool storage_read(u32 offset, void *dest, u32 size);
+    bool storage_program(u32 offset, const void *source, u32 size);
+    bool storage_erase(u32 offset);
+    bool storage_busy();
+
+#endif
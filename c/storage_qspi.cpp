@@ -0,0 +1,127 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: The storage area on the QSPI boot flash, driven in I/O mode
+// with polled transfers from the main loop. Only the plain single line
+// commands are used so any of the usual 16 MB parts will do.
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "xparameters.h"
+#include "xqspips.h"
+#include "storage.hpp"
+
+/*
+Flash commands and the QSPI controller
+    -QSPI_DEVICE_ID     : used to specify the QSPI controller in device
+    -QSPI_HEADER        : command byte and 24 bit address ahead of the data
+    -QSPI               : instance of the QSPI controller
+*/
+#define QSPI_DEVICE_ID      XPAR_XQSPIPS_0_DEVICE_ID
+#define QSPI_WRITE_ENABLE   0x06
+#define QSPI_READ_STATUS    0x05
+#define QSPI_READ           0x03
+#define QSPI_PAGE_PROGRAM   0x02
+#define QSPI_SECTOR_ERASE   0xD8
+#define QSPI_STATUS_WIP     0x01
+#define QSPI_HEADER         4
+
+static XQspiPs QSPI;
+static bool ready = false;
+
+// Transfers send and receive the same number of bytes, a read
+// gets its data back after the header
+static u8 send_buf[QSPI_HEADER + STORAGE_PAGE_BYTES];
+static u8 recv_buf[QSPI_HEADER + STORAGE_PAGE_BYTES];
+
+static void header(u8 command, u32 offset) {
+    u32 addr = STORAGE_FLASH_OFFSET + offset;
+
+    send_buf[0] = command;
+    send_buf[1] = (u8) (addr >> 16);
+    send_buf[2] = (u8) (addr >> 8);
+    send_buf[3] = (u8) addr;
+    return;
+}
+
+static void write_enable() {
+    send_buf[0] = QSPI_WRITE_ENABLE;
+    XQspiPs_PolledTransfer(&QSPI, send_buf, NULL, 1);
+    return;
+}
+
+bool storage_init() {
+    XQspiPs_Config *QspiConfig;
+
+    QspiConfig = XQspiPs_LookupConfig(QSPI_DEVICE_ID);
+    if (NULL == QspiConfig) {
+        return false;
+    }
+    if (XQspiPs_CfgInitialize(&QSPI, QspiConfig, QspiConfig->BaseAddress) != XST_SUCCESS) {
+        return false;
+    }
+
+    XQspiPs_SetOptions(&QSPI, XQSPIPS_MANUAL_START_OPTION | XQSPIPS_FORCE_SSELECT_OPTION | XQSPIPS_HOLD_B_DRIVE_OPTION);
+    XQspiPs_SetClkPrescaler(&QSPI, XQSPIPS_CLK_PRESCALE_8);
+    XQspiPs_SetSlaveSelect(&QSPI);
+    ready = true;
+    return true;
+}
+
+// One page at a time through the transfer buffers
+bool storage_read(u32 offset, void *dest, u32 size) {
+    u8 *bytes = (u8 *) dest;
+    u32 n;
+
+    if (!ready || offset + size > STORAGE_BYTES || storage_busy()) {
+        return false;
+    }
+
+    while (size > 0) {
+        n = (size < STORAGE_PAGE_BYTES) ? size : STORAGE_PAGE_BYTES;
+        header(QSPI_READ, offset);
+        XQspiPs_PolledTransfer(&QSPI, send_buf, recv_buf, QSPI_HEADER + n);
+        memcpy(bytes, recv_buf + QSPI_HEADER, n);
+        bytes += n;
+        offset += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool storage_program(u32 offset, const void *source, u32 size) {
+    if (!ready || offset + size > STORAGE_BYTES || offset / STORAGE_PAGE_BYTES != (offset + size - 1) / STORAGE_PAGE_BYTES || storage_busy()) {
+        return false;
+    }
+
+    write_enable();
+    header(QSPI_PAGE_PROGRAM, offset);
+    memcpy(send_buf + QSPI_HEADER, source, size);
+    XQspiPs_PolledTransfer(&QSPI, send_buf, NULL, QSPI_HEADER + size);
+    return true;
+}
+
+bool storage_erase(u32 offset) {
+    if (!ready || offset >= STORAGE_BYTES || storage_busy()) {
+        return false;
+    }
+
+    write_enable();
+    header(QSPI_SECTOR_ERASE, offset - offset % STORAGE_SECTOR_BYTES);
+    XQspiPs_PolledTransfer(&QSPI, send_buf, NULL, QSPI_HEADER);
+    return true;
+}
+
+// Write in progress bit of the status register
+bool storage_busy() {
+    u8 command[2] = {QSPI_READ_STATUS, 0};
+    u8 status[2];
+
+    if (!ready) {
+        return false;
+    }
+    XQspiPs_PolledTransfer(&QSPI, command, status, sizeof(command));
+    return (status[1] & QSPI_STATUS_WIP) != 0;
+}
@@ -0,0 +1,398 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Sysex decoding, chunk loads and dumps, see sysex.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include "xil_printf.h"
+#include "xil_io.h"
+#include "xil_exception.h"
+#include "sysex.hpp"
+#include "functions.hpp"
+#include "telemetry.hpp"
+#include "recorder.hpp"
+#include "zones.hpp"
+
+// Reset the decoder after the sysex start byte
+void sysex_decoder::start() {
+    position = 0;
+    command = 0;
+    target = 0;
+    chunk = 0;
+    table = NULL;
+    dest_size = 0;
+    target_size = 0;
+    offset = 0;
+    msbs = 0;
+    group = 0;
+    has_pending = false;
+    sum = 0;
+    valid = true;
+    return;
+}
+
+// Find the table the chunk is for and how much of it the chunk covers.
+// The chunk is decoded into the chunk buffer, table is where end()
+// copies it once its checksum is good
+void sysex_decoder::open_target() {
+    switch (target) {
+        case SYSEX_TARGET_STATE :
+            staged = read_state();
+            table = (unsigned char *) &staged;
+            target_size = sizeof(staged);
+            break;
+
+        case SYSEX_TARGET_PRESETS :
+            table = (unsigned char *) presets;
+            target_size = sizeof(presets);
+            break;
+
+        case SYSEX_TARGET_TUNING :
+            table = (unsigned char *) staged_tuning;
+            target_size = sizeof(staged_tuning);
+            break;
+
+        case SYSEX_TARGET_SCALE :
+            table = (unsigned char *) &staged_scale;
+            target_size = sizeof(staged_scale);
+            break;
+
+        case SYSEX_TARGET_OFFSETS :
+            table = (unsigned char *) &staged_offsets;
+            target_size = sizeof(staged_offsets);
+            break;
+
+        case SYSEX_TARGET_ZONES :
+            table = (unsigned char *) zones.definitions();
+            target_size = ZONES_MAX * sizeof(zone);
+            break;
+
+        default :
+            valid = false;
+            return;
+    }
+
+    offset = 0;
+    if (chunk * SYSEX_CHUNK_BYTES >= target_size) {
+        valid = false;
+    }
+    else if (target_size - chunk * SYSEX_CHUNK_BYTES > SYSEX_CHUNK_BYTES) {
+        dest_size = SYSEX_CHUNK_BYTES;
+    }
+    else {
+        dest_size = target_size - chunk * SYSEX_CHUNK_BYTES;
+    }
+    return;
+}
+
+// Unpack one 7 bit byte into the chunk buffer
+void sysex_decoder::decode(unsigned char x) {
+    if (group == 0) {
+        msbs = x;
+    }
+    else {
+        if (offset < dest_size) {
+            chunk_data[offset] = x | (((msbs >> (group-1)) & 0x01) << 7);
+            offset += 1;
+        }
+        else {
+            valid = false;
+        }
+    }
+
+    group = (group == 7) ? 0 : group+1;
+    return;
+}
+
+// Called for every data byte between the start and end bytes. The newest
+// byte is held back since it is the checksum if the message ends next
+void sysex_decoder::receive(unsigned char x) {
+    switch (position) {
+        case 0  : valid = (x == SYSEX_ID);  break;
+        case 1  : command = x;              break;
+        case 2  : target = x;               break;
+        case 3  : chunk = x;                break;
+        case 4  :
+            chunk |= x << 7;
+            if (valid && command == SYSEX_DATA) {
+                open_target();
+            }
+            break;
+
+        default :
+            if (valid && command == SYSEX_DATA) {
+                sum += x;
+                if (has_pending) {
+                    decode(pending);
+                }
+                pending = x;
+                has_pending = true;
+            }
+            break;
+    }
+    position += 1;
+    return;
+}
+
+// A status byte other than the end byte cancels the message
+void sysex_decoder::abort() {
+    valid = false;
+    return;
+}
+
+// Called on the sysex end byte
+void sysex_decoder::end() {
+    bool good;
+
+    if (!valid || position < 3) {
+        return;
+    }
+
+    if (command == SYSEX_SET_BAUD) {
+        reply(set_baud(target) ? SYSEX_ACK : SYSEX_NAK, target, 0);
+    }
+
+    else if (command == SYSEX_SET_TELEMETRY) {
+        telemetry.set_period(target);
+        reply(SYSEX_ACK, target, 0);
+    }
+
+    else if (command == SYSEX_DUMP_REQUEST && target < SYSEX_NUM_TARGETS) {
+        dump_target = target;
+    }
+
+    else if (command == SYSEX_DATA) {
+        good = has_pending && (sum & 0x7F) == 0;
+        if (good) {
+            memcpy(table + chunk * SYSEX_CHUNK_BYTES, chunk_data, offset);
+        }
+        if (good && target == SYSEX_TARGET_STATE) {
+            load_state(staged);
+        }
+        if (good && target >= SYSEX_TARGET_TUNING) {
+            count_chunk();
+        }
+        reply(good ? SYSEX_ACK : SYSEX_NAK, target, chunk);
+    }
+    valid = false;
+    return;
+}
+
+// Mark a good chunk of a tuning or zone target. Once every chunk of the
+// target is in the tuning is built and swapped in, or the zone routes rebuilt
+void sysex_decoder::count_chunk() {
+    unsigned int chunks = (target_size + SYSEX_CHUNK_BYTES-1) / SYSEX_CHUNK_BYTES;
+
+    if (chunks_target != target) {
+        chunks_target = target;
+        chunks_good = 0;
+    }
+    chunks_good |= 1 << chunk;
+    if (chunks_good != (1u << chunks) - 1) {
+        return;
+    }
+
+    chunks_target = -1;
+    chunks_good = 0;
+    if (target == SYSEX_TARGET_ZONES) {
+        zones.request();
+    }
+    else {
+        tuning_target = target;
+    }
+    return;
+}
+
+// Queue an answer to a message, called from the interrupt
+void sysex_decoder::reply(unsigned char code, unsigned char x, unsigned int number) {
+    unsigned int head = reply_head;
+
+    if (head - reply_tail >= SYSEX_REPLIES) {
+        return;
+    }
+    replies[head % SYSEX_REPLIES] = (code << 24) | (x << 16) | (number & 0x3FFF);
+    reply_head = head+1;
+    return;
+}
+
+// Send the queued answers over the debug uart
+void sysex_decoder::send_replies() {
+    unsigned int tail = reply_tail;
+    unsigned int x;
+
+    while (tail != reply_head) {
+        x = replies[tail % SYSEX_REPLIES];
+        outbyte(SYSEX_START);
+        outbyte(SYSEX_ID);
+        outbyte(x >> 24);
+        outbyte((x >> 16) & 0x7F);
+        outbyte(x & 0x7F);
+        outbyte((x >> 7) & 0x7F);
+        outbyte(SYSEX_END);
+        tail = tail+1;
+        reply_tail = tail;
+    }
+    return;
+}
+
+// Start a dump of a target. The state and telemetry are copied
+// so every chunk of them comes from the same moment
+void sysex_decoder::open_dump(unsigned char x) {
+    switch (x) {
+        case SYSEX_TARGET_STATE :
+            dump_state = read_state();
+            dump_source = (const unsigned char *) &dump_state;
+            dump_size = sizeof(dump_state);
+            break;
+
+        case SYSEX_TARGET_PRESETS :
+            dump_source = (const unsigned char *) presets;
+            dump_size = sizeof(presets);
+            break;
+
+        case SYSEX_TARGET_SCALE :
+            dump_source = (const unsigned char *) &staged_scale;
+            dump_size = sizeof(staged_scale);
+            break;
+
+        case SYSEX_TARGET_OFFSETS :
+            dump_source = (const unsigned char *) &staged_offsets;
+            dump_size = sizeof(staged_offsets);
+            break;
+
+        case SYSEX_TARGET_TELEMETRY :
+            dump_frame = telemetry.snapshot();
+            dump_source = (const unsigned char *) &dump_frame;
+            dump_size = sizeof(dump_frame);
+            break;
+
+        case SYSEX_TARGET_RECORDER :
+            dump_source = recorder.data();
+            dump_size = recorder.size();
+            break;
+
+        case SYSEX_TARGET_ZONES :
+            dump_source = (const unsigned char *) zones.definitions();
+            dump_size = ZONES_MAX * sizeof(zone);
+            break;
+
+        default :
+            dump_source = (const unsigned char *) tuning_word;
+            dump_size = NUM_TUNING_WORDS * sizeof(unsigned int);
+            break;
+    }
+
+    dumping = x;
+    dump_chunk = 0;
+    return;
+}
+
+// Send the next chunk of the dump over the debug uart as a
+// data chunk, the dump ends with its last chunk
+void sysex_decoder::dump_next() {
+    unsigned int base = dump_chunk * SYSEX_CHUNK_BYTES;
+    unsigned int length;
+    unsigned char packed;
+    unsigned char check = 0;
+
+    if (base >= dump_size) {
+        dumping = -1;
+        return;
+    }
+    length = (dump_size - base > SYSEX_CHUNK_BYTES) ? SYSEX_CHUNK_BYTES : dump_size - base;
+
+    outbyte(SYSEX_START);
+    outbyte(SYSEX_ID);
+    outbyte(SYSEX_DATA);
+    outbyte((unsigned char) dumping);
+    outbyte(dump_chunk & 0x7F);
+    outbyte((dump_chunk >> 7) & 0x7F);
+
+    for (unsigned int i=0; i<length; i+=7) {
+        packed = 0;
+        for (unsigned int j=0; j<7 && i+j<length; ++j) {
+            packed |= (dump_source[base+i+j] >> 7) << j;
+        }
+        outbyte(packed);
+        check += packed;
+
+        for (unsigned int j=0; j<7 && i+j<length; ++j) {
+            outbyte(dump_source[base+i+j] & 0x7F);
+            check += dump_source[base+i+j] & 0x7F;
+        }
+    }
+
+    outbyte((128 - (check & 0x7F)) & 0x7F);
+    outbyte(SYSEX_END);
+    dump_chunk = dump_chunk+1;
+    if (base + length >= dump_size) {
+        dumping = -1;
+    }
+    return;
+}
+
+// Build the shadow table from a received tuning and make it active.
+// The source is copied with the interrupts masked so a new message
+// cannot change it part way through the build
+void sysex_decoder::load_tuning(unsigned char x) {
+    tuning_scale scale;
+    tuning_offsets offsets;
+    unsigned int *shadow;
+
+    switch (x) {
+        case SYSEX_TARGET_TUNING :
+            shadow = tuning_shadow();
+            Xil_ExceptionDisable();
+            memcpy(shadow, staged_tuning, sizeof(staged_tuning));
+            Xil_ExceptionEnable();
+            break;
+
+        case SYSEX_TARGET_SCALE :
+            Xil_ExceptionDisable();
+            scale = staged_scale;
+            Xil_ExceptionEnable();
+            tuning_build_scale(scale);
+            break;
+
+        case SYSEX_TARGET_OFFSETS :
+            Xil_ExceptionDisable();
+            offsets = staged_offsets;
+            Xil_ExceptionEnable();
+            tuning_build_offsets(offsets);
+            break;
+
+        default :
+            break;
+    }
+
+    tuning_swap();
+    return;
+}
+
+// Called from the main loop so answers, dumps and tuning builds never
+// run inside the interrupt. The answers go first, then a dump sends
+// one chunk per call
+void sysex_decoder::service() {
+    int x = dump_target;
+
+    send_replies();
+
+    if (x >= 0) {
+        dump_target = -1;
+        open_dump(x);
+    }
+    if (dumping >= 0) {
+        dump_next();
+    }
+
+    x = tuning_target;
+    if (x >= 0) {
+        tuning_target = -1;
+        load_tuning(x);
+    }
+    return;
+}
@@ -0,0 +1,159 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: System exclusive bulk transfers of the synth state, the preset
+// bank, the tuning tables and the keyboard zones.
+//
+//  F0 7D <command> <target> [<chunk lsb> <chunk msb> <data ...> <checksum>] F7
+//
+//      -command    : SYSEX_DUMP_REQUEST, SYSEX_DATA, SYSEX_SET_BAUD or SYSEX_SET_TELEMETRY
+//      -target     : SYSEX_TARGET_STATE, SYSEX_TARGET_PRESETS, SYSEX_TARGET_TUNING,
+//                    SYSEX_TARGET_SCALE, SYSEX_TARGET_OFFSETS, SYSEX_TARGET_ZONES or, for dumps only,
+//                    SYSEX_TARGET_TELEMETRY and SYSEX_TARGET_RECORDER. For SYSEX_SET_BAUD the index of the
+//                    new midi uart rate, for SYSEX_SET_TELEMETRY the stream period
+//      -chunk      : 14 bit chunk number, each chunk covers SYSEX_CHUNK_BYTES of the target
+//      -data       : 8 bit data packed 7 bytes into 8. The first byte of each group
+//                    holds the msb of the following bytes, bit 0 for the first
+//      -checksum   : chosen so the packed data plus checksum sum to 0 mod 128
+//
+// Each data chunk is answered with SYSEX_ACK or SYSEX_NAK and the chunk number
+// over the debug uart. Every chunk is decoded into a chunk buffer and only
+// copied into its target once its checksum is good. Answers are queued by
+// the interrupt and sent when the main loop calls service(), so they never
+// land inside a telemetry frame or a dump chunk. A full queue drops the
+// answer and the host times out and resends. Dumps are sent over the debug
+// uart as data chunks, one chunk each time the main loop calls service() so
+// a long dump never holds up the loop. The state and telemetry are snapshot
+// when the dump starts, a new request drops a dump still being sent.
+// SYSEX_SET_BAUD takes effect after the end byte, rates are 31250, 1M, 2M
+// and 3M baud. SYSEX_SET_TELEMETRY sets the period of the telemetry stream
+// in steps of TELEMETRY_PERIOD_MS, 0 stops it.
+//
+// The three tuning targets never touch the active table. SYSEX_TARGET_TUNING
+// takes tuning words, SYSEX_TARGET_SCALE a tuning_scale and
+// SYSEX_TARGET_OFFSETS a tuning_offsets, each into a staged copy. Once every
+// chunk of the target has been good the main loop builds the shadow table
+// from it and swaps it in. SYSEX_TARGET_ZONES takes ZONES_MAX zone
+// definitions the same way, the main loop rebuilds the routes from them. A
+// chunk for another target starts the count again.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_SYSEX_HPP
+#define MYLIB_SYSEX_HPP
+
+#include <stdio.h>
+#include "constants.hpp"
+#include "tuning.hpp"
+#include "zones.hpp"
+#include "telemetry.hpp"
+
+    #define SYSEX_ID                0x7D
+
+    #define SYSEX_DUMP_REQUEST      0x01
+    #define SYSEX_DATA              0x02
+    #define SYSEX_SET_BAUD          0x03
+    #define SYSEX_SET_TELEMETRY     0x04
+    #define SYSEX_NAK               0x7E
+    #define SYSEX_ACK               0x7F
+
+    #define SYSEX_TARGET_STATE      0x00
+    #define SYSEX_TARGET_PRESETS    0x01
+    #define SYSEX_TARGET_TUNING     0x02
+    #define SYSEX_TARGET_SCALE      0x03
+    #define SYSEX_TARGET_OFFSETS    0x04
+    #define SYSEX_TARGET_TELEMETRY  0x05
+    #define SYSEX_TARGET_RECORDER   0x06
+    #define SYSEX_TARGET_ZONES      0x07
+    #define SYSEX_NUM_TARGETS       8
+
+    #define SYSEX_CHUNK_BYTES       256
+    #define SYSEX_REPLIES           8
+
+class sysex_decoder {
+    unsigned int position;
+    unsigned char command;
+    unsigned char target;
+    unsigned int chunk;
+    unsigned char *table;
+    unsigned int dest_size;
+    unsigned int target_size;
+    unsigned int offset;
+    unsigned char msbs;
+    unsigned int group;
+    unsigned char pending;
+    bool has_pending;
+    unsigned char sum;
+    bool valid;
+    volatile int dump_target;
+    volatile int tuning_target;
+    int chunks_target;
+    unsigned int chunks_good;
+    unsigned int replies[SYSEX_REPLIES];
+    volatile unsigned int reply_head;
+    volatile unsigned int reply_tail;
+    int dumping;
+    unsigned int dump_chunk;
+    const unsigned char *dump_source;
+    unsigned int dump_size;
+    synth_state dump_state;
+    telemetry_frame dump_frame;
+    unsigned char chunk_data[SYSEX_CHUNK_BYTES];
+    synth_state staged;
+    unsigned int staged_tuning[NUM_TUNING_WORDS];
+    tuning_scale staged_scale;
+    tuning_offsets staged_offsets;
+
+    void open_target();
+    void decode(unsigned char);
+    void count_chunk();
+    void reply(unsigned char, unsigned char, unsigned int);
+    void send_replies();
+    void open_dump(unsigned char);
+    void dump_next();
+    void load_tuning(unsigned char);
+
+    public:
+
+        sysex_decoder() {
+            position = 0;
+            command = 0;
+            target = 0;
+            chunk = 0;
+            table = NULL;
+            dest_size = 0;
+            target_size = 0;
+            offset = 0;
+            msbs = 0;
+            group = 0;
+            pending = 0;
+            has_pending = false;
+            sum = 0;
+            valid = false;
+            dump_target = -1;
+            tuning_target = -1;
+            chunks_target = -1;
+            chunks_good = 0;
+            reply_head = 0;
+            reply_tail = 0;
+            dumping = -1;
+            dump_chunk = 0;
+            dump_source = NULL;
+            dump_size = 0;
+            staged_scale = tuning_scale();
+            staged_offsets = tuning_offsets();
+
+            for (unsigned int i=0; i<NUM_TUNING_WORDS; ++i) {
+                staged_tuning[i] = 0;
+            }
+        }
+
+        void start();
+        void receive(unsigned char);
+        void end();
+        void abort();
+        void service();
+};
+
+#endif
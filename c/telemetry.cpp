@@ -0,0 +1,137 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Telemetry snapshots and the debug uart stream, see telemetry.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "xil_printf.h"
+#include "xil_exception.h"
+#include "telemetry.hpp"
+#include "linked_list.hpp"
+#include "midi_parser.hpp"
+#include "midi_clock.hpp"
+#include "last_state.hpp"
+
+telemetry_monitor telemetry;
+
+// Start the clocks, called once from synth_init
+void telemetry_monitor::init() {
+    XTime_GetTime(&boot);
+    window_start = boot;
+    last_frame = boot;
+    ready_at = 0;
+    first_note_at = 0;
+    return;
+}
+
+// Main loop about to start, the end of the boot time
+void telemetry_monitor::ready() {
+    XTime_GetTime(&ready_at);
+    return;
+}
+
+// Boot stage time in microseconds, 0 until the stage is reached
+static u32 boot_us(XTime boot, XTime at) {
+    return (at == 0) ? 0 : (u32) ((at - boot) / (COUNTS_PER_SECOND / 1000000));
+}
+
+// Copy the counters with the interrupts masked so no
+// handler lands between the words of the copy
+telemetry_frame telemetry_monitor::snapshot() {
+    telemetry_frame frame;
+    telemetry_counters live;
+    u32 merged;
+    XTime now;
+
+    Xil_ExceptionDisable();
+    live = count;
+    merged = controls.merged_count();
+    Xil_ExceptionEnable();
+    XTime_GetTime(&now);
+
+    frame.sequence = sequence;
+    frame.uptime_ms = (u32) ((now - boot) / (COUNTS_PER_SECOND / 1000));
+    for (unsigned int i=0; i<TELEMETRY_NUM_IRQS; ++i) {
+        frame.irq_count[i] = live.irq_count[i];
+    }
+    frame.parser_errors = live.parser_errors;
+    frame.notes_dropped = live.notes_dropped;
+    frame.notes_stolen = live.notes_stolen;
+    channels.count_voices(&frame.voices_active, &frame.voices_releasing);
+    frame.uart_fifo_irq_peak = live.uart_fifo_irq_peak;
+    frame.uart_overruns = live.uart_overruns;
+    frame.axi_writes = live.axi_writes;
+    frame.axi_writes_per_sec = writes_per_sec;
+    frame.isr_load = isr_load;
+    frame.tempo_mbpm = tempo.tempo_mbpm();
+    frame.arp_steps = live.arp_steps;
+    frame.arp_jitter_max_ns = (u32) ((u64) live.arp_jitter_max * 1000000000ULL / COUNTS_PER_SECOND);
+    frame.arp_jitter_mean_ns = (live.arp_steps == 0) ? 0 : (u32) (live.arp_jitter_sum / live.arp_steps * 1000000000ULL / COUNTS_PER_SECOND);
+    frame.boot_ready_us = boot_us(boot, ready_at);
+    frame.boot_first_note_us = boot_us(boot, first_note_at);
+    frame.last_state = last_state.get_sequence();
+    frame.controls_merged = merged;
+    return frame;
+}
+
+// Stream period in TELEMETRY_PERIOD_MS steps, 0 stops the stream
+void telemetry_monitor::set_period(unsigned char x) {
+    period = x;
+    return;
+}
+
+// Binary frame over the debug uart
+void telemetry_monitor::send(const telemetry_frame &frame) {
+    const unsigned char *bytes = (const unsigned char *) &frame;
+    unsigned int sum_1 = 0;
+    unsigned int sum_2 = 0;
+
+    outbyte(TELEMETRY_SYNC_0);
+    outbyte(TELEMETRY_SYNC_1);
+    outbyte(TELEMETRY_VERSION);
+    outbyte(sizeof(frame));
+
+    for (unsigned int i=0; i<sizeof(frame); ++i) {
+        outbyte(bytes[i]);
+        sum_1 = (sum_1 + bytes[i]) % 255;
+        sum_2 = (sum_2 + sum_1) % 255;
+    }
+
+    outbyte(sum_1);
+    outbyte(sum_2);
+    return;
+}
+
+// Called from the main loop. Closes the one second rate window
+// and sends a frame when the stream period is up
+void telemetry_monitor::service() {
+    XTime now;
+    u32 writes;
+    u64 ticks;
+    unsigned int x = period;
+
+    XTime_GetTime(&now);
+
+    if (now - window_start >= COUNTS_PER_SECOND) {
+        Xil_ExceptionDisable();
+        writes = count.axi_writes;
+        ticks = count.isr_ticks;
+        Xil_ExceptionEnable();
+
+        writes_per_sec = (u32) ((u64) (writes - window_writes) * COUNTS_PER_SECOND / (now - window_start));
+        isr_load = (u32) (((ticks - window_ticks) << 16) / (now - window_start));
+        window_writes = writes;
+        window_ticks = ticks;
+        window_start = now;
+    }
+
+    if (x != 0 && now - last_frame >= (XTime) x * (COUNTS_PER_SECOND / 1000) * TELEMETRY_PERIOD_MS) {
+        last_frame = now;
+        send(snapshot());
+        sequence += 1;
+    }
+    return;
+}
@@ -0,0 +1,202 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Runtime counters of the firmware, bumped in place by the
+// interrupt handlers, the parser and the voice list, and sampled by the main
+// loop. A snapshot is sent as a telemetry_frame, either every stream period
+// over the debug uart or on a sysex dump request. tools/telemetry decodes
+// and plots both.
+//
+// Stream frames are binary, all words little endian:
+//
+//      A5 5A <version> <length> <telemetry_frame> <fletcher lsb> <fletcher msb>
+//
+//      -length     : bytes in the frame
+//      -fletcher   : Fletcher-16 of the frame bytes
+//
+// Every synth register write goes through synth_out32 so the bus load can
+// be counted and the write logged by the flight recorder. Counters bumped
+// from the main loop race the handlers and can drop a count, the handlers'
+// own counts are exact.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_TELEMETRY_HPP
+#define MYLIB_TELEMETRY_HPP
+
+#include <stdio.h>
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xtime_l.h"
+#include "recorder.hpp"
+
+    #define TELEMETRY_SYNC_0        0xA5
+    #define TELEMETRY_SYNC_1        0x5A
+    #define TELEMETRY_VERSION       4
+
+    // Handlers counted in irq_count
+    #define TELEMETRY_IRQ_SYNTH     0
+    #define TELEMETRY_IRQ_UART      1
+    #define TELEMETRY_IRQ_WAVE_SEL  2
+    #define TELEMETRY_IRQ_TIMER     3
+    #define TELEMETRY_NUM_IRQS      4
+
+    // Stream period unit, and the period at power up (0 is off)
+    #define TELEMETRY_PERIOD_MS     100
+    #ifndef TELEMETRY_PERIOD_INIT
+        #define TELEMETRY_PERIOD_INIT   0
+    #endif
+
+    /*
+    Live counters, all running totals
+        -irq_count          : entries of each interrupt handler
+        -isr_ticks          : global timer counts spent inside the handlers
+        -parser_errors      : unknown status bytes and control changes
+        -notes_dropped      : note ons that found no channel
+        -notes_stolen       : groups cut to make room for a note on
+        -uart_fifo_irq_peak : highest midi fifo level read on entry to the uart
+                              interrupt, the fifo is not seen between interrupts
+        -uart_overruns      : overrun count of the uart status register, 8 bits and wraps
+        -axi_writes         : synth register writes
+        -arp_steps          : notes played by the arpeggiator
+        -arp_jitter_max     : latest an arpeggiator note has been, global timer counts
+        -arp_jitter_sum     : lateness of all arpeggiator notes, global timer counts
+    */
+    struct telemetry_counters {
+        u32 irq_count[TELEMETRY_NUM_IRQS] = {};
+        u64 isr_ticks = 0;
+        u32 parser_errors = 0;
+        u32 notes_dropped = 0;
+        u32 notes_stolen = 0;
+        u32 uart_fifo_irq_peak = 0;
+        u32 uart_overruns = 0;
+        u32 axi_writes = 0;
+        u32 arp_steps = 0;
+        u32 arp_jitter_max = 0;
+        u64 arp_jitter_sum = 0;
+    };
+
+    /*
+    Fixed size block sent to the host, every field is a 32 bit word
+        -sequence           : frame number, gaps show lost frames
+        -uptime_ms          : time since power up
+        -irq_count          : as telemetry_counters
+        -parser_errors      : as telemetry_counters
+        -notes_dropped      : as telemetry_counters
+        -notes_stolen       : as telemetry_counters
+        -voices_active      : channels sounding a held note
+        -voices_releasing   : channels waiting on the release interrupt
+        -uart_fifo_irq_peak : as telemetry_counters
+        -uart_overruns      : as telemetry_counters
+        -axi_writes         : as telemetry_counters
+        -axi_writes_per_sec : synth register writes over the last second
+        -isr_load           : share of the last second spent in the handlers,
+                              0.16 fixed point so 65536 is all of it
+        -tempo_mbpm         : tracked midi clock tempo, thousandths of a bpm
+        -arp_steps          : as telemetry_counters
+        -arp_jitter_max_ns  : latest an arpeggiator note has been against the tracked clock
+        -arp_jitter_mean_ns : mean lateness of the arpeggiator notes
+        -boot_ready_us      : synth_init to the first pass of the main loop
+        -boot_first_note_us : synth_init to the first note on the fabric, 0 before it
+        -last_state         : sequence of the stored last state restored or written
+        -controls_merged    : controller messages the coalescer overwrote before applying
+    */
+    struct telemetry_frame {
+        u32 sequence;
+        u32 uptime_ms;
+        u32 irq_count[TELEMETRY_NUM_IRQS];
+        u32 parser_errors;
+        u32 notes_dropped;
+        u32 notes_stolen;
+        u32 voices_active;
+        u32 voices_releasing;
+        u32 uart_fifo_irq_peak;
+        u32 uart_overruns;
+        u32 axi_writes;
+        u32 axi_writes_per_sec;
+        u32 isr_load;
+        u32 tempo_mbpm;
+        u32 arp_steps;
+        u32 arp_jitter_max_ns;
+        u32 arp_jitter_mean_ns;
+        u32 boot_ready_us;
+        u32 boot_first_note_us;
+        u32 last_state;
+        u32 controls_merged;
+    };
+
+class telemetry_monitor {
+    XTime boot;
+    XTime ready_at;
+    XTime first_note_at;
+    XTime window_start;
+    XTime last_frame;
+    u32 window_writes;
+    u64 window_ticks;
+    u32 writes_per_sec;
+    u32 isr_load;
+    u32 sequence;
+    volatile unsigned int period;
+
+    void send(const telemetry_frame &);
+
+    public:
+
+        telemetry_counters count;
+
+        telemetry_monitor() {
+            boot = 0;
+            ready_at = 0;
+            first_note_at = 0;
+            window_start = 0;
+            last_frame = 0;
+            window_writes = 0;
+            window_ticks = 0;
+            writes_per_sec = 0;
+            isr_load = 0;
+            sequence = 0;
+            period = TELEMETRY_PERIOD_INIT;
+        }
+
+        // Time stamp at the top of a handler
+        XTime enter() {
+            XTime now;
+            XTime_GetTime(&now);
+            return now;
+        }
+
+        // Count a handler that started at start
+        void leave(unsigned int irq, XTime start) {
+            XTime now;
+            XTime_GetTime(&now);
+            count.irq_count[irq] += 1;
+            count.isr_ticks += now - start;
+            return;
+        }
+
+        // First note on the fabric since synth_init, the end of the boot to first note time
+        void note_played() {
+            if (first_note_at == 0) {
+                XTime_GetTime(&first_note_at);
+            }
+            return;
+        }
+
+        void init();
+        void ready();
+        telemetry_frame snapshot();
+        void set_period(unsigned char);
+        void service();
+};
+
+    extern telemetry_monitor telemetry;
+
+    // Every synth register write, counted for the bus load and recorded
+    static inline void synth_out32(UINTPTR addr, u32 value) {
+        telemetry.count.axi_writes += 1;
+        recorder.log(RECORDER_WRITE, (u32) addr, value);
+        Xil_Out32(addr, value);
+    }
+
+#endif
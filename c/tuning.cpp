@@ -0,0 +1,174 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Building, swapping and retuning the tuning tables, see tuning.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "xil_exception.h"
+#include "tuning.hpp"
+#include "linked_list.hpp"
+#include "midi_parser.hpp"
+#include "zones.hpp"
+
+#ifdef TUNING_SCALE_HEADER
+#include TUNING_SCALE_HEADER
+#endif
+
+    static unsigned int tuning_bank[2][NUM_TUNING_WORDS];
+    unsigned int *tuning_word = tuning_bank[0];
+
+    // Set once the shadow holds words that differ from the active table
+    static bool shadow_staged = false;
+
+    // 2^x ~ 1 + y + y^2/2 + y^3/6 with y = x ln 2, under a semitone the
+    // words land within a hundredth of a cent
+    constexpr detune_ratio LN2_PER_CENT = detune_ratio::from_real(0.69314718055994531/1200);
+    constexpr detune_ratio RATIO_ONE    = detune_ratio::from_real(1.0);
+    constexpr detune_ratio RATIO_HALF   = detune_ratio::from_real(1.0/2);
+    constexpr detune_ratio RATIO_SIXTH  = detune_ratio::from_real(1.0/6);
+
+    static unsigned int *shadow_table() {
+        return (tuning_word == tuning_bank[0]) ? tuning_bank[1] : tuning_bank[0];
+    }
+
+    // Tuning word of a pitch given as 16.16 cents above C0. The 12 TET word of
+    // the semitone below is raised by the rest of the semitone, pitches off
+    // the ends of the table are folded in by octaves
+    static unsigned int cents_word(long long cents) {
+        const long long semitone = 100LL << 16;
+        long long n = cents / semitone;
+        int octaves = 0;
+
+        if (cents - n*semitone < 0) {
+            n = n-1;
+        }
+        cents_fmt fine = cents_fmt::from_raw(cents - n*semitone);
+
+        while (n < 0) {
+            n = n+12;
+            octaves = octaves-1;
+        }
+        while (n >= NUM_TUNING_WORDS) {
+            n = n-12;
+            octaves = octaves+1;
+        }
+
+        detune_ratio y = (fine * LN2_PER_CENT).convert<2,30>();
+        detune_ratio y2 = (y * y).convert<2,30>();
+        detune_ratio y3 = (y2 * y).convert<2,30>();
+        detune_ratio ratio = fixed_add<2,30>(fixed_add<2,30>(RATIO_ONE, y),
+                                             fixed_add<2,30>((y2 * RATIO_HALF).convert<2,30>(),
+                                                             (y3 * RATIO_SIXTH).convert<2,30>()));
+
+        unsigned long long word = fixed_mult<32,0>(tuning_fmt::from_word(TUNING_WORD[n]), ratio).word();
+        if (octaves < 0) {
+            word = (octaves > -32) ? word >> -octaves : 0;
+        }
+        else if (octaves > 0) {
+            word = (octaves < 32) ? word << octaves : ~0ULL;
+        }
+
+        // Keep the word positive, phase_modulate.v reads it signed
+        return (word > 0x7FFFFFFF) ? 0x7FFFFFFF : (unsigned int) word;
+    }
+
+    // 12 TET, or the build's own scale, both tables
+    void tuning_init() {
+    #ifdef TUNING_SCALE_HEADER
+        tuning_build_scale(BUILD_SCALE);
+    #else
+        tuning_reset();
+    #endif
+        for (int i=0; i<NUM_TUNING_WORDS; i=i+1) {
+            tuning_word[i] = shadow_table()[i];
+        }
+        shadow_staged = false;
+        return;
+    }
+
+    // The table a sysex load writes into. It starts as a copy of the
+    // active table so a load of part of it keeps the rest
+    unsigned int *tuning_shadow() {
+        unsigned int *shadow = shadow_table();
+
+        if (!shadow_staged) {
+            for (int i=0; i<NUM_TUNING_WORDS; i=i+1) {
+                shadow[i] = tuning_word[i];
+            }
+            shadow_staged = true;
+        }
+        return shadow;
+    }
+
+    void tuning_reset() {
+        unsigned int *shadow = shadow_table();
+
+        for (int i=0; i<NUM_TUNING_WORDS; i=i+1) {
+            shadow[i] = TUNING_WORD[i];
+        }
+        shadow_staged = true;
+        return;
+    }
+
+    void tuning_build_scale(const tuning_scale &scale) {
+        unsigned int *shadow = shadow_table();
+        long long degrees = scale.degrees;
+        long long root = scale.root;
+        long long steps, periods, degree;
+
+        if (degrees < 1) {
+            degrees = 1;
+        }
+        else if (degrees > TUNING_MAX_DEGREES) {
+            degrees = TUNING_MAX_DEGREES;
+        }
+        if (root >= NUM_TUNING_WORDS) {
+            root = NUM_TUNING_WORDS-1;
+        }
+
+        for (long long i=0; i<NUM_TUNING_WORDS; ++i) {
+            steps = i - root;
+            periods = steps / degrees;
+            degree = steps - periods*degrees;
+            if (degree < 0) {
+                degree = degree + degrees;
+                periods = periods-1;
+            }
+
+            shadow[i] = cents_word((root*100 << 16)
+                                   + periods*scale.cents[degrees-1]
+                                   + (degree ? scale.cents[degree-1] : 0));
+        }
+        shadow_staged = true;
+        return;
+    }
+
+    void tuning_build_offsets(const tuning_offsets &offsets) {
+        unsigned int *shadow = shadow_table();
+
+        for (long long i=0; i<NUM_TUNING_WORDS; ++i) {
+            shadow[i] = cents_word((i*100 << 16) + offsets.cents[i]);
+        }
+        shadow_staged = true;
+        return;
+    }
+
+    // Make the shadow table active and move every sounding note onto it.
+    // The zone routes are built for the new table first and swapped with
+    // it. The interrupts are masked so no note on or off is decoded against
+    // the new table before the channels hold its words
+    void tuning_swap() {
+        unsigned int *shadow = tuning_shadow();
+
+        zones.build(shadow);
+        Xil_ExceptionDisable();
+        tuning_word = shadow;
+        zones.swap();
+        shadow_staged = false;
+        channels.retune(patch);
+        Xil_ExceptionEnable();
+        return;
+    }
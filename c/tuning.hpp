@@ -0,0 +1,54 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Double buffered tuning tables. tuning_word points at the active
+// table and decode_note reads it with one indexed load. New tunings are built
+// into the shadow table from the main loop, never from the note path, and
+// tuning_swap makes them active with one pointer store and retunes the
+// sounding notes in one batch.
+//
+// A build can start on a scale of its own by defining TUNING_SCALE_HEADER as
+// a header that declares BUILD_SCALE, tools/scala writes one from a .scl file.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_TUNING_HPP
+#define MYLIB_TUNING_HPP
+
+#include "constants.hpp"
+
+    #define TUNING_MAX_DEGREES  128
+
+    /*
+    Scale in the form of a Scala file, repeated every period above and below the root
+        -root       : table entry the scale starts on, it keeps its 12 TET pitch
+        -degrees    : notes in one period
+        -cents      : cents_fmt words, degrees 1 to degrees above the root. The
+                      last one is the period
+    */
+    struct tuning_scale {
+        unsigned int root;
+        unsigned int degrees;
+        int cents[TUNING_MAX_DEGREES];
+    };
+
+    /*
+    Offset of every table entry from 12 TET
+        -cents      : cents_fmt words added to the entries, entry n is n*100 cents above C0
+    */
+    struct tuning_offsets {
+        int cents[NUM_TUNING_WORDS];
+    };
+
+    // Active table
+    extern unsigned int *tuning_word;
+
+    void tuning_init();
+    unsigned int *tuning_shadow();
+    void tuning_reset();
+    void tuning_build_scale(const tuning_scale &);
+    void tuning_build_offsets(const tuning_offsets &);
+    void tuning_swap();
+
+#endif
@@ -0,0 +1,171 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Zone routing table build and note on resolve, see zones.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "xil_exception.h"
+#include "zones.hpp"
+#include "tuning.hpp"
+#include "linked_list.hpp"
+#include "midi_parser.hpp"
+
+zone_map zones;
+
+static_assert(sizeof(zone) == 8, "zones are sent byte for byte");
+
+    // The transposed keys decode_note plays, tuning index 0 is key 12
+    #define ZONE_LOWEST_NOTE    12
+    #define ZONE_HIGHEST_NOTE   143
+
+zone_route *zone_map::shadow() {
+    return (route == routes[0]) ? routes[1] : routes[0];
+}
+
+// Called from synth_init once the tuning table is set up
+void zone_map::init() {
+    for (unsigned int z=0; z<ZONES_MAX; ++z) {
+        compiled[z] = defined[z];
+    }
+    build(tuning_word);
+    swap();
+    return;
+}
+
+// Zone definitions, a sysex load copies each good chunk into
+// them and calls request once the last one is in
+zone *zone_map::definitions() {
+    return defined;
+}
+
+// Rebuild the routes on the next service
+void zone_map::request() {
+    stale = true;
+    return;
+}
+
+// Build the shadow routes and velocity maps from the compiled zones
+// against a tuning table, tuning_swap builds them for its new table
+void zone_map::build(const unsigned int *table) {
+    zone_route *next = shadow();
+    unsigned char (*curve)[ZONE_KEYS] = curves[(next == routes[0]) ? 0 : 1];
+    const zone *defs = compiled;
+    zone_layer *layer;
+    int x;
+    int mod;
+
+    // Velocity 0 is a note off and never reaches a zone
+    for (unsigned int z=0; z<ZONES_MAX; ++z) {
+        curve[z][0] = 0;
+        for (unsigned int v=1; v<ZONE_KEYS; ++v) {
+            if (v < defs[z].low_velocity || v > defs[z].high_velocity || defs[z].level == 0) {
+                curve[z][v] = 0;
+            }
+            else {
+                curve[z][v] = (unsigned char) ((v * defs[z].level + 126) / 127);
+            }
+        }
+    }
+
+    for (unsigned int k=0; k<ZONE_KEYS; ++k) {
+        next[k].count = 0;
+        for (unsigned int z=0; z<ZONES_MAX && next[k].count<ZONE_LAYERS; ++z) {
+            if (defs[z].channel == ZONE_OFF || k < defs[z].low_key || k > defs[z].high_key) {
+                continue;
+            }
+
+            x = (int) k + defs[z].transpose;
+            if (x < ZONE_LOWEST_NOTE || x > ZONE_HIGHEST_NOTE) {
+                continue;
+            }
+            x = x - ZONE_LOWEST_NOTE;
+            mod = (int) defs[z].patch - 60 + x;
+            if (defs[z].patch != ZONE_PATCH_LIVE && (mod < 0 || mod >= NUM_TUNING_WORDS)) {
+                continue;
+            }
+
+            layer = &next[k].layer[next[k].count];
+            layer->note.index = (unsigned char) x;
+            layer->note.carrier = table[x];
+            layer->note.modulator = (defs[z].patch == ZONE_PATCH_LIVE) ? 0 : table[mod];
+            layer->zone = (unsigned char) z;
+            layer->channel = defs[z].channel;
+            layer->patch = defs[z].patch;
+            layer->velocity = curve[z];
+            next[k].count += 1;
+        }
+    }
+    return;
+}
+
+// Make the shadow routes active, one pointer store
+void zone_map::swap() {
+    route = shadow();
+    return;
+}
+
+// Layers of a note on, out holds ZONE_LAYERS. Called from the note path
+// so everything but the live modulator word comes out of the route
+unsigned int zone_map::resolve(unsigned char key, unsigned char channel, unsigned char velocity, zone_voice *out) {
+    const zone_route *r = &route[key & 0x7F];
+    const zone_layer *layer;
+    unsigned int count = 0;
+
+    for (unsigned int l=0; l<r->count; ++l) {
+        layer = &r->layer[l];
+        if ((layer->channel != ZONE_OMNI && layer->channel != channel) || layer->velocity[velocity & 0x7F] == 0) {
+            continue;
+        }
+        out[count].note = layer->note;
+        if (layer->patch == ZONE_PATCH_LIVE) {
+            out[count].note.modulator = tuning_word[(patch-60)+layer->note.index];
+        }
+        out[count].zone = layer->zone;
+        out[count].patch = layer->patch;
+        out[count].velocity = layer->velocity[velocity & 0x7F];
+        count += 1;
+    }
+    return count;
+}
+
+// Play every layer of the key, false if no zone takes the note
+bool zone_map::note_on(unsigned char key, unsigned char channel, unsigned char velocity) {
+    zone_voice layers[ZONE_LAYERS];
+    unsigned int count = resolve(key, channel, velocity, layers);
+
+    if (count == 0) {
+        return false;
+    }
+    channels.note_on(key, channel, layers, count);
+    return true;
+}
+
+// Every layer of a key is released together, whatever the zones
+// are now, so a note off never depends on its velocity or the routes
+void zone_map::note_off(unsigned char key, unsigned char channel) {
+    channels.note_off(key, channel);
+    return;
+}
+
+// Called from the main loop. The definitions are copied with the
+// interrupts masked so a sysex load is never caught half way, notes
+// already sounding keep the words they were started with
+void zone_map::service() {
+    if (!stale) {
+        return;
+    }
+
+    Xil_ExceptionDisable();
+    stale = false;
+    for (unsigned int z=0; z<ZONES_MAX; ++z) {
+        compiled[z] = defined[z];
+    }
+    Xil_ExceptionEnable();
+
+    build(tuning_word);
+    swap();
+    return;
+}
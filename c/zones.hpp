@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Keyboard zones, for splits and layers. A zone plays a range of
+// keys, at a range of velocities, from one midi channel or all of them, with
+// its own transpose, modulator patch and level. Every zone a key falls in is
+// a layer of that key, and all the layers of a note on are allocated as one
+// group so they start, release and get stolen together.
+//
+// The zones are compiled into a routing table of NUM_MIDI_NOTES entries that
+// holds the carrier and modulator words of each layer and a velocity map
+// folding in the velocity range and level, so a note on resolves its layers
+// with one load of its route. Like the tuning tables the routes are double
+// buffered, a change of zones is built into the shadow routes from the main
+// loop and made active with one pointer store. A tuning swap builds the
+// routes for the new table first and swaps both together.
+//
+// Layers that follow the PATCH controller take the modulator word at note
+// on, the one load decode_note has always made, so a patch change needs no
+// rebuild. At power up zone 0 covers the whole keyboard on every channel and
+// the synth plays as it did without zones.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_ZONES_HPP
+#define MYLIB_ZONES_HPP
+
+#include <stdio.h>
+#include "constants.hpp"
+
+    #define ZONES_MAX           8
+    #define ZONE_LAYERS         4
+    #define ZONE_KEYS           128
+
+    // Channel of a zone that takes every channel, and of one that is not used
+    #define ZONE_OMNI           16
+    #define ZONE_OFF            0xFF
+
+    // Patch of a zone that follows the PATCH controller
+    #define ZONE_PATCH_LIVE     0xFF
+
+    // Tells the voices of a key apart by the channel it came in on and the
+    // zone that played it, never 0 so the software voices can mark a free voice
+    #define VOICE_ID(key, source, zone)     (0x01000000 | ((zone) << 16) | ((source) << 8) | (key))
+
+    /*
+    One zone, the layout is sent byte for byte by SYSEX_TARGET_ZONES
+        -low_key        : lowest key played
+        -high_key       : highest key played
+        -low_velocity   : lowest note on velocity played
+        -high_velocity  : highest note on velocity played
+        -channel        : midi channel 0 to 15, ZONE_OMNI for all, ZONE_OFF if unused
+        -transpose      : semitones added to the key, signed
+        -patch          : modulator patch as the PATCH controller, ZONE_PATCH_LIVE to follow it
+        -level          : scales the velocity into the attack level, 127 plays it as sent
+    */
+    struct zone {
+        unsigned char low_key = 0;
+        unsigned char high_key = 127;
+        unsigned char low_velocity = 1;
+        unsigned char high_velocity = 127;
+        unsigned char channel = ZONE_OMNI;
+        signed char transpose = 0;
+        unsigned char patch = ZONE_PATCH_LIVE;
+        unsigned char level = 127;
+    };
+
+    /*
+    A layer of one key in the routing table
+        -note       : transposed carrier and modulator words and tuning index,
+                      the modulator is 0 for a layer that follows the controller
+        -zone       : zone number
+        -channel    : as the zone
+        -patch      : as the zone
+        -velocity   : velocity the layer plays at for each note on velocity,
+                      0 outside the zone's range
+    */
+    struct zone_layer {
+        car_mod note;
+        unsigned char zone;
+        unsigned char channel;
+        unsigned char patch;
+        const unsigned char *velocity;
+    };
+
+    struct zone_route {
+        unsigned int count;
+        zone_layer layer[ZONE_LAYERS];
+    };
+
+    /*
+    A layer picked for a note on, what the voice list needs to play it
+        -note       : carrier and modulator words and tuning index
+        -zone       : zone number
+        -patch      : as the zone, kept by the voices for patch changes and retuning
+        -velocity   : velocity to play at
+    */
+    struct zone_voice {
+        car_mod note;
+        unsigned char zone;
+        unsigned char patch;
+        unsigned char velocity;
+    };
+
+class zone_map {
+    zone defined[ZONES_MAX];
+    zone compiled[ZONES_MAX];
+    zone_route routes[2][ZONE_KEYS];
+    unsigned char curves[2][ZONES_MAX][ZONE_KEYS];
+    zone_route *volatile route;
+    volatile bool stale;
+
+    zone_route *shadow();
+
+    public:
+
+        zone_map() {
+            for (unsigned int z=1; z<ZONES_MAX; ++z) {
+                defined[z].channel = ZONE_OFF;
+                compiled[z].channel = ZONE_OFF;
+            }
+            for (unsigned int b=0; b<2; ++b) {
+                for (unsigned int k=0; k<ZONE_KEYS; ++k) {
+                    routes[b][k].count = 0;
+                }
+            }
+            route = routes[0];
+            stale = false;
+        }
+
+        void init();
+        zone *definitions();
+        void request();
+        void build(const unsigned int *);
+        void swap();
+        unsigned int resolve(unsigned char, unsigned char, unsigned char, zone_voice *);
+        bool note_on(unsigned char, unsigned char, unsigned char);
+        void note_off(unsigned char, unsigned char);
+        void service();
+};
+
+    extern zone_map zones;
+
+#endif
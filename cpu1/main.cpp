@@ -0,0 +1,87 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Second core. Takes note commands from the mailbox, renders the
+// software voices a block at a time and streams each block to the stream_mix
+// input with the AXI DMA. Two buffers alternate, one is rendered while the
+// other is on its way, and the DMA is paced by the mix FIFO so this loop runs
+// at the sample rate without a timer. Built as its own application on
+// ps7_cortexa9_1 with USE_AMP, see scripts/build_vitis.tcl.
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "xparameters.h"
+#include "xil_io.h"
+#include "xil_cache.h"
+#include "xil_mmu.h"
+#include "xpseudo_asm.h"
+#include "xaxidma.h"
+#include <stdio.h>
+#include "constants.hpp"
+#include "soft_link.hpp"
+#include "soft_voice.hpp"
+
+static XAxiDma dma;
+static soft_engine engine;
+static int blocks[2][SOFT_BLOCK] __attribute__ ((aligned (32)));
+
+// Apply every command posted since the last block
+static void take_commands(soft_mailbox *box) {
+    unsigned int tail = box->tail;
+    soft_command *cmd;
+
+    while (tail != box->head) {
+        dmb();
+        cmd = &box->ring[tail % SOFT_RING];
+        if (cmd->voice < SOFT_VOICES) {
+            if (cmd->type == SOFT_NOTE_ON) {
+                engine.note_on(cmd->voice, cmd->car, cmd->mod, cmd->velocity);
+            }
+            else if (cmd->type == SOFT_NOTE_OFF) {
+                engine.note_off(cmd->voice);
+            }
+        }
+        tail = tail+1;
+    }
+    box->tail = tail;
+    return;
+}
+
+int main(void) {
+    soft_mailbox *box = (soft_mailbox *) SOFT_MAILBOX_ADDR;
+    XAxiDma_Config *config;
+    unsigned int current = 0;
+
+    Xil_SetTlbAttributes(SOFT_MAILBOX_ADDR, SOFT_MAILBOX_ATTR);
+
+    config = XAxiDma_LookupConfig(XPAR_AXI_DMA_0_DEVICE_ID);
+    if (config == NULL || XAxiDma_CfgInitialize(&dma, config) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    XAxiDma_IntrDisable(&dma, XAXIDMA_IRQ_ALL_MASK, XAXIDMA_DMA_TO_DEVICE);
+
+    box->alive = SOFT_ALIVE;
+
+    while (1) {
+        take_commands(box);
+
+        // The envelope rates follow whatever the fabric voices use
+        engine.set_rates(Xil_In32(RC_ATTACK_ADDR), Xil_In32(RC_RELEASE_ADDR), Xil_In32(MOD_TAU_ADDR));
+        engine.render(blocks[current], SOFT_BLOCK);
+        box->busy = engine.busy();
+
+        if (!XAxiDma_Busy(&dma, XAXIDMA_DMA_TO_DEVICE)) {
+            box->late = box->late+1;
+        }
+        while (XAxiDma_Busy(&dma, XAXIDMA_DMA_TO_DEVICE)) {
+        }
+
+        Xil_DCacheFlushRange((UINTPTR) blocks[current], sizeof(blocks[current]));
+        XAxiDma_SimpleTransfer(&dma, (UINTPTR) blocks[current], sizeof(blocks[current]), XAXIDMA_DMA_TO_DEVICE);
+        box->blocks = box->blocks+1;
+        current = current ^ 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,314 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Render kernel of the software voices. All math is Q31 style
+// fixed point, a product of two Q31 words is (a*b) >> 31, which is one
+// vqdmulh on NEON. The vector helpers below are the only code that differs
+// between NEON, SSE4.1 and the plain C build.
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "soft_voice.hpp"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+
+    #define SOFT_KERNEL "neon"
+
+    typedef int32x4_t soft_vec;
+
+    static inline soft_vec vec_load(const int *p)           { return vld1q_s32(p); }
+    static inline void vec_store(int *p, soft_vec a)        { vst1q_s32(p, a); }
+    static inline soft_vec vec_dup(int x)                   { return vdupq_n_s32(x); }
+    static inline soft_vec vec_add(soft_vec a, soft_vec b)  { return vaddq_s32(a, b); }
+    static inline soft_vec vec_sub(soft_vec a, soft_vec b)  { return vsubq_s32(a, b); }
+    static inline soft_vec vec_q31(soft_vec a, soft_vec b)  { return vqdmulhq_s32(a, b); }
+    template <int N> static inline soft_vec vec_shl(soft_vec a)     { return vshlq_n_s32(a, N); }
+    template <int N> static inline soft_vec vec_sra(soft_vec a)     { return vshrq_n_s32(a, N); }
+    template <int N> static inline soft_vec vec_srl(soft_vec a)     { return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), N)); }
+
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+
+    #define SOFT_KERNEL "sse4.1"
+
+    typedef __m128i soft_vec;
+
+    static inline soft_vec vec_load(const int *p)           { return _mm_loadu_si128((const __m128i *) p); }
+    static inline void vec_store(int *p, soft_vec a)        { _mm_storeu_si128((__m128i *) p, a); }
+    static inline soft_vec vec_dup(int x)                   { return _mm_set1_epi32(x); }
+    static inline soft_vec vec_add(soft_vec a, soft_vec b)  { return _mm_add_epi32(a, b); }
+    static inline soft_vec vec_sub(soft_vec a, soft_vec b)  { return _mm_sub_epi32(a, b); }
+    template <int N> static inline soft_vec vec_shl(soft_vec a)     { return _mm_slli_epi32(a, N); }
+    template <int N> static inline soft_vec vec_sra(soft_vec a)     { return _mm_srai_epi32(a, N); }
+    template <int N> static inline soft_vec vec_srl(soft_vec a)     { return _mm_srli_epi32(a, N); }
+
+    // Even lanes keep bits 62:31 in their low word and odd lanes in their
+    // high word, then one blend puts the four results back together
+    static inline soft_vec vec_q31(soft_vec a, soft_vec b) {
+        soft_vec even = _mm_srli_epi64(_mm_mul_epi32(a, b), 31);
+        soft_vec odd = _mm_slli_epi64(_mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)), 1);
+        return _mm_blend_epi16(even, odd, 0xCC);
+    }
+
+#else
+
+    #define SOFT_KERNEL "scalar"
+
+    struct soft_vec {
+        int lane[SOFT_LANES];
+    };
+
+    static inline soft_vec vec_load(const int *p) {
+        soft_vec a;
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            a.lane[i] = p[i];
+        }
+        return a;
+    }
+
+    static inline void vec_store(int *p, soft_vec a) {
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            p[i] = a.lane[i];
+        }
+        return;
+    }
+
+    static inline soft_vec vec_dup(int x) {
+        soft_vec a;
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            a.lane[i] = x;
+        }
+        return a;
+    }
+
+    // Phases wrap, so the sums are done unsigned
+    static inline soft_vec vec_add(soft_vec a, soft_vec b) {
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            a.lane[i] = (int) ((unsigned int) a.lane[i] + (unsigned int) b.lane[i]);
+        }
+        return a;
+    }
+
+    static inline soft_vec vec_sub(soft_vec a, soft_vec b) {
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            a.lane[i] = (int) ((unsigned int) a.lane[i] - (unsigned int) b.lane[i]);
+        }
+        return a;
+    }
+
+    static inline soft_vec vec_q31(soft_vec a, soft_vec b) {
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            a.lane[i] = (int) (((long long) a.lane[i] * b.lane[i]) >> 31);
+        }
+        return a;
+    }
+
+    template <int N> static inline soft_vec vec_shl(soft_vec a) {
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            a.lane[i] = (int) ((unsigned int) a.lane[i] << N);
+        }
+        return a;
+    }
+
+    template <int N> static inline soft_vec vec_sra(soft_vec a) {
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            a.lane[i] = a.lane[i] >> N;
+        }
+        return a;
+    }
+
+    template <int N> static inline soft_vec vec_srl(soft_vec a) {
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            a.lane[i] = (int) ((unsigned int) a.lane[i] >> N);
+        }
+        return a;
+    }
+
+#endif
+
+    // Envelope floor and modulation target, rc_filter_fsm MIN and
+    // phase_modulate STEP moved to the formats used here
+    #define SOFT_ENV_MIN    (8 << 8)
+    #define SOFT_MOD_STEP   0x40000000
+
+    /*
+    Quarter wave sine in Q30, built at compile time to the same words lut_gen
+    writes to hdl/lut.mem, round(sin(pi/2 k/depth) 2^16) clamped to 18 bits.
+    The Taylor series to x^19 is well inside half an lsb over a quarter wave
+    */
+    struct soft_lut {
+        int q30[SOFT_LUT_DEPTH];
+
+        constexpr soft_lut() : q30() {
+            for (int k=0; k<SOFT_LUT_DEPTH; ++k) {
+                double x = 1.5707963267948966 * k / SOFT_LUT_DEPTH;
+                double term = x;
+                double sum = x;
+                for (int n=3; n<=19; n+=2) {
+                    term = -term * x * x / ((n-1) * n);
+                    sum = sum + term;
+                }
+                long long word = (long long) (sum * 65536 + 0.5);
+                if (word > 131071) {
+                    word = 131071;
+                }
+                q30[k] = (int) (word << 14);
+            }
+        }
+    };
+
+    static constexpr soft_lut sine_table;
+
+    // Full wave from the quarter table, the mirroring of quadrant.v
+    static inline int sine(unsigned int phase) {
+        unsigned int quad = phase >> 30;
+        unsigned int addr = (phase >> 15) & (SOFT_LUT_DEPTH-1);
+
+        if (quad & 1) {
+            addr = SOFT_LUT_DEPTH-1-addr;
+        }
+        return (quad & 2) ? -sine_table.q30[addr] : sine_table.q30[addr];
+    }
+
+    // Tables have no vector gather, each lane looks up on its own
+    static inline soft_vec vec_sine(soft_vec phase) {
+        int lane[SOFT_LANES];
+
+        vec_store(lane, phase);
+        for (unsigned int i=0; i<SOFT_LANES; ++i) {
+            lane[i] = sine((unsigned int) lane[i]);
+        }
+        return vec_load(lane);
+    }
+
+
+// Start a voice, velocity is the VEL register word with the attack
+// level in 31:16. A voice that is still releasing picks up from where
+// its envelope is, the same as a fabric channel
+void soft_engine::note_on(unsigned int v, unsigned int car, unsigned int mod, unsigned int velocity) {
+    voice.car_word[v] = (int) car;
+    voice.mod_word[v] = (int) mod;
+    voice.step[v] = (int) ((velocity >> 16) << 16);
+    voice.mod_step[v] = SOFT_MOD_STEP;
+    active |= (1u << v);
+    return;
+}
+
+// Let a voice fall away at the release rate
+void soft_engine::note_off(unsigned int v) {
+    voice.step[v] = 0;
+    voice.mod_step[v] = 0;
+    return;
+}
+
+// Envelope rates from the fabric registers, the 16 bit RC_ATTACK and
+// RC_RELEASE taus are scaled by 2^-22 in rc_filter_fsm and MOD_TAU is 4.28.
+// rc_filter_fsm has no decay stage, RC_DECAY is not used there either
+void soft_engine::set_rates(unsigned int rc_attack, unsigned int rc_release, unsigned int mod_tau_reg) {
+    attack_tau = (int) ((rc_attack & 0xFFFF) << 9);
+    release_tau = (int) ((rc_release & 0xFFFF) << 9);
+    mod_tau = (int) (mod_tau_reg << 3);
+    return;
+}
+
+// Render count samples of the group of voices starting at first and add
+// them to acc, one column per lane. The state stays in registers for the
+// whole block. Each lane takes the attack rate while its note is held
+// and the release rate after, as rc_filter_fsm
+void soft_engine::render_group(int (*acc)[SOFT_LANES], unsigned int first, unsigned int count) {
+    int rate[SOFT_LANES];
+
+    for (unsigned int i=0; i<SOFT_LANES; ++i) {
+        rate[i] = (voice.step[first+i] != 0) ? attack_tau : release_tau;
+    }
+
+    soft_vec car_phase = vec_load(&voice.car_phase[first]);
+    soft_vec mod_phase = vec_load(&voice.mod_phase[first]);
+    soft_vec car_word = vec_load(&voice.car_word[first]);
+    soft_vec mod_word = vec_load(&voice.mod_word[first]);
+    soft_vec env = vec_load(&voice.env[first]);
+    soft_vec step = vec_load(&voice.step[first]);
+    soft_vec mod_env = vec_load(&voice.mod_env[first]);
+    soft_vec mod_step = vec_load(&voice.mod_step[first]);
+    soft_vec tau = vec_load(rate);
+    soft_vec m_tau = vec_dup(mod_tau);
+    soft_vec car_half = vec_srl<1>(car_word);
+    soft_vec offset;
+    soft_vec sample;
+
+    for (unsigned int n=0; n<count; ++n) {
+        // Modulator and its envelope
+        mod_phase = vec_add(mod_phase, mod_word);
+        mod_env = vec_add(mod_env, vec_q31(vec_sub(mod_step, mod_env), m_tau));
+
+        // Phase offset is tuning word * modulator * envelope, the half
+        // word keeps the product signed and the shift puts back the 2^5
+        offset = vec_shl<5>(vec_q31(vec_q31(car_half, vec_sine(mod_phase)), mod_env));
+        car_phase = vec_add(car_phase, vec_add(car_word, offset));
+
+        // Carrier shaped by the amplitude envelope, Q29 down to 8.16. The
+        // envelope step is floored to the 2.22 lsb of rc_filter_fsm so the
+        // tail falls a fabric lsb a sample and ends when the fabric does
+        env = vec_add(env, vec_shl<8>(vec_sra<8>(vec_q31(vec_sub(step, env), tau))));
+        sample = vec_sra<13>(vec_q31(vec_sine(car_phase), env));
+        vec_store(acc[n], vec_add(vec_load(acc[n]), sample));
+    }
+
+    vec_store(&voice.car_phase[first], car_phase);
+    vec_store(&voice.mod_phase[first], mod_phase);
+    vec_store(&voice.env[first], env);
+    vec_store(&voice.mod_env[first], mod_env);
+    return;
+}
+
+// Render count 8.16 samples of every sounding voice into out. Voices
+// whose envelope has fallen under the floor after note off are retired
+void soft_engine::render(int *out, unsigned int count) {
+    int acc[SOFT_BLOCK][SOFT_LANES];
+    unsigned int n;
+
+    while (count != 0) {
+        n = (count < SOFT_BLOCK) ? count : SOFT_BLOCK;
+        for (unsigned int i=0; i<n; ++i) {
+            for (unsigned int j=0; j<SOFT_LANES; ++j) {
+                acc[i][j] = 0;
+            }
+        }
+
+        for (unsigned int first=0; first<SOFT_VOICES; first+=SOFT_LANES) {
+            if ((active >> first) & ((1u << SOFT_LANES) - 1)) {
+                render_group(acc, first, n);
+            }
+        }
+
+        for (unsigned int i=0; i<n; ++i) {
+            out[i] = acc[i][0];
+            for (unsigned int j=1; j<SOFT_LANES; ++j) {
+                out[i] += acc[i][j];
+            }
+        }
+        out += n;
+        count -= n;
+    }
+
+    for (unsigned int v=0; v<SOFT_VOICES; ++v) {
+        if (voice.step[v] == 0 && voice.env[v] < SOFT_ENV_MIN) {
+            voice.env[v] = 0;
+            active &= ~(1u << v);
+        }
+    }
+    return;
+}
+
+// Voices still sounding, one bit per voice
+unsigned int soft_engine::busy() {
+    return active;
+}
+
+// Vector extension the kernel was built with
+const char *soft_kernel() {
+    return SOFT_KERNEL;
+}
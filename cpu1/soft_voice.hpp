@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Software FM voices for the second core. Each voice is one fabric
+// channel worked out in fixed point, the same quarter wave table as cos_lut,
+// the modulation envelope of phase_modulate and the amplitude envelope of
+// rc_filter_fsm. Voices are rendered SOFT_LANES at a time with NEON on the
+// A9, SSE4.1 on x86 for benchmarking, and plain C anywhere else. Samples come
+// out 8.16 at the I2S word rate, ready for the stream_mix input.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_SOFT_VOICE_HPP
+#define MYLIB_SOFT_VOICE_HPP
+
+#include <stdio.h>
+#include "soft_link.hpp"
+
+    #define SOFT_LANES      4
+    #define SOFT_BLOCK      64
+    #define SOFT_LUT_DEPTH  32768
+
+    /*
+    Voice state, one entry per voice so a group of SOFT_LANES voices loads as one vector
+        -car_phase  : carrier phase accumulator
+        -mod_phase  : modulator phase accumulator
+        -car_word   : carrier tuning word, the same words as the CAR registers
+        -mod_word   : modulator tuning word
+        -env        : amplitude envelope, the rc_filter_fsm envelope in Q30
+        -step       : amplitude target, the attack level while the note is held
+                      and 0 once released, which also picks the rate
+        -mod_env    : modulation envelope, 4.28 like phase_modulate
+        -mod_step   : modulation target, 4.0 while the note is held
+    */
+    struct soft_state {
+        int car_phase[SOFT_VOICES];
+        int mod_phase[SOFT_VOICES];
+        int car_word[SOFT_VOICES];
+        int mod_word[SOFT_VOICES];
+        int env[SOFT_VOICES];
+        int step[SOFT_VOICES];
+        int mod_env[SOFT_VOICES];
+        int mod_step[SOFT_VOICES];
+    };
+
+class soft_engine {
+    soft_state voice;
+    int attack_tau;
+    int release_tau;
+    int mod_tau;
+    unsigned int active;
+
+    void render_group(int (*)[SOFT_LANES], unsigned int, unsigned int);
+
+    public:
+
+        soft_engine() {
+            for (unsigned int i=0; i<SOFT_VOICES; ++i) {
+                voice.car_phase[i] = 0;
+                voice.mod_phase[i] = 0;
+                voice.car_word[i] = 0;
+                voice.mod_word[i] = 0;
+                voice.env[i] = 0;
+                voice.step[i] = 0;
+                voice.mod_env[i] = 0;
+                voice.mod_step[i] = 0;
+            }
+            attack_tau = 0;
+            release_tau = 0;
+            mod_tau = 0;
+            active = 0;
+        }
+
+        void note_on(unsigned int, unsigned int, unsigned int, unsigned int);
+        void note_off(unsigned int);
+        void set_rates(unsigned int, unsigned int, unsigned int);
+        void render(int *, unsigned int);
+        unsigned int busy();
+};
+
+    const char *soft_kernel();
+
+#endif
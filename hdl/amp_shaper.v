@@ -27,7 +27,9 @@ module amp_shaper #
     input   wire    [NUM_BITS_TAU-1:0]  release_tau,
     input   wire    [NUM_BITS_WORD-1:0] word_in,
     output  wire    [NUM_BITS_WORD-1:0] word_out,
-    output  wire                        available
+    output  wire                        available,
+    output  wire    [23:0]              envelope_out,
+    output  wire    [1:0]               stage
     );
 
     localparam integer ENV_BITS = 24;
@@ -47,9 +49,12 @@ module amp_shaper #
             .decay_tau      (decay_tau),
             .release_tau    (release_tau),
             .available      (available),
-            .envelope       (envelope)
+            .envelope       (envelope),
+            .stage          (stage)
         );
 
+    assign envelope_out = envelope;
+
     fixed_point_mult #(
             .WI_1   (2),
             .WF_1   (NUM_BITS_WORD-2),
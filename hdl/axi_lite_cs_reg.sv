@@ -15,7 +15,7 @@ import const_pckg::*;
 
 module axi_lite_cs_reg #(
     parameter integer C_DATA_WIDTH      = 32,
-    parameter integer C_NUM_REG         = 51,
+    parameter integer C_NUM_REG         = 80,
     parameter integer C_ADDR_WIDTH      = ($clog2(C_NUM_REG) + 2),
     parameter integer C_NUM_BITS_TAU    = 16
     )(
@@ -57,7 +57,9 @@ module axi_lite_cs_reg #(
     output  wire    [7:0]                   volume_reg,
     output  wire    [1:0]                   wave_sel,
     output  wire    [C_DATA_WIDTH-1:0]      mod_tau,
-    output  wire                            mod_enable
+    output  wire                            mod_enable,
+    // Status inputs, envelope word of each channel
+    input   wire    [`PCKD_BITS-1:0]        envelope_in
     );
 
     // 31   mod_amp     vol    a_tau   d_tau   r_tau
@@ -262,7 +264,24 @@ module axi_lite_cs_reg #(
                     RC_DECAY_ADDR       : read_data   <= rc_decay_reg;
                     RC_RELEASE_ADDR     : read_data   <= rc_release_reg;
                     MOD_TAU_ADDR        : read_data   <= mod_tau_reg;
-                
+                    //------------------------------------------------
+                    ENVELOPE_0_ADDR     : read_data   <= envelope_in[0*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_1_ADDR     : read_data   <= envelope_in[1*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_2_ADDR     : read_data   <= envelope_in[2*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_3_ADDR     : read_data   <= envelope_in[3*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_4_ADDR     : read_data   <= envelope_in[4*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_5_ADDR     : read_data   <= envelope_in[5*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_6_ADDR     : read_data   <= envelope_in[6*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_7_ADDR     : read_data   <= envelope_in[7*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_8_ADDR     : read_data   <= envelope_in[8*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_9_ADDR     : read_data   <= envelope_in[9*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_10_ADDR    : read_data   <= envelope_in[10*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_11_ADDR    : read_data   <= envelope_in[11*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_12_ADDR    : read_data   <= envelope_in[12*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_13_ADDR    : read_data   <= envelope_in[13*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_14_ADDR    : read_data   <= envelope_in[14*C_DATA_WIDTH +: C_DATA_WIDTH];
+                    ENVELOPE_15_ADDR    : read_data   <= envelope_in[15*C_DATA_WIDTH +: C_DATA_WIDTH];
+
                     default : begin
                         read_data <= 0;
                         read_resp   <= C_DEC_ERR;
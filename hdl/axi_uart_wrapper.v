@@ -7,13 +7,24 @@
 // Design Name: FM SYNTHESIZER
 //
 // Description: 
+//
+//      0x0     RX data, read only. Reading pops the fifo
+//              8       data valid, clear when the fifo was empty
+//              7:0     received byte
+//      0x4     Status, read only. The counters wrap
+//              31:24   noisy samples
+//              23:16   framing errors
+//              15:8    bytes dropped on a full fifo
+//              7:0     fifo level
+//      0x8     Baud divider, clock cycles per bit in 16.8 fixed point
 //////////////////////////////////////////////////////////////////////////////////
 
 module axi_uart_wrapper #(
     parameter integer C_DATA_WIDTH      = 32,
     parameter integer C_ADDR_WIDTH      = 4,
     parameter integer C_LSB_FIRST       = 1,
-    parameter integer C_FIFO_DEPTH      = 64
+    parameter integer C_FIFO_DEPTH      = 64,
+    parameter integer C_BAUD_DIV        = 24'h0414E6
 
     )(
     // Clock and reset
@@ -53,18 +64,46 @@ module axi_uart_wrapper #(
     localparam  [1:0]   C_SLV_ERR   = 2'b10;
     localparam  [1:0]   C_DEC_ERR   = 2'b11;
 
-    reg [C_DATA_WIDTH-1:0]  register;
+    localparam  [1:0]   RX_DATA_ADDR    = 2'd0;
+    localparam  [1:0]   STATUS_ADDR     = 2'd1;
+    localparam  [1:0]   BAUD_DIV_ADDR   = 2'd2;
+
+    reg [23:0]              baud_div;
+    reg [7:0]               overrun_cnt;
+    reg [7:0]               frame_err_cnt;
+    reg [7:0]               noise_cnt;
 
     wire[7:0]               midi_out;
     wire[7:0]               fifo_out;
+    wire[$clog2(C_FIFO_DEPTH):0] fifo_count;
+    wire[7:0]               fifo_level;
     reg [C_ADDR_WIDTH-1:0]  read_address;
+    reg [C_ADDR_WIDTH-1:0]  write_address;
     reg [C_DATA_WIDTH-1:0]  read_data;
+    reg [C_DATA_WIDTH-1:0]  write_data;
     reg [1:0]               read_resp;
+    reg [1:0]               write_resp;
     reg                     rd_addr_rdy;
     reg                     rd_data_vld;
+    reg                     wr_addr_rdy;
+    reg                     wr_data_rdy;
+    reg                     write_valid;
     reg                     rd_en;
+    reg                     wr_addr_good;
+    reg                     wr_data_good;
+    wire                    fifo_pop;
     wire                    word_vld;
+    wire                    overrun;
+    wire                    frame_err;
+    wire                    noise_flg;
+
+    assign fifo_level       = fifo_count;
+    assign fifo_pop         = rd_en & (read_address[3:2] == RX_DATA_ADDR);
 
+    assign s_axi_awready    = wr_addr_rdy;
+    assign s_axi_wready     = wr_data_rdy;
+    assign s_axi_bresp      = write_resp;
+    assign s_axi_bvalid     = write_valid;
     assign s_axi_arready    = rd_addr_rdy;
     assign s_axi_rdata      = read_data;
     assign s_axi_rresp      = read_resp;
@@ -94,10 +133,19 @@ module axi_uart_wrapper #(
 
             // Output read data
             if (rd_en) begin
-                read_data   <= {{24{1'b0}}, fifo_out};
                 read_resp   <= C_OKAY;
                 rd_data_vld <= 1'b1;
                 rd_en       <= 1'b0;
+                case (read_address[3:2])
+                    RX_DATA_ADDR    : read_data <= {{23{1'b0}}, (fifo_level != 0), fifo_out};
+                    STATUS_ADDR     : read_data <= {noise_cnt, frame_err_cnt, overrun_cnt, fifo_level};
+                    BAUD_DIV_ADDR   : read_data <= {{8{1'b0}}, baud_div};
+
+                    default : begin
+                        read_data   <= 0;
+                        read_resp   <= C_DEC_ERR;
+                    end
+                endcase
             end
 
             else begin
@@ -109,14 +157,93 @@ module axi_uart_wrapper #(
         end
     end
 
+    // Write process
+    always @(posedge s_axi_aclk) begin
+        if (~s_axi_aresetn) begin
+            wr_addr_rdy     <= 1'b0;
+            write_address   <= 0;
+            wr_data_rdy     <= 1'b0;
+            write_data      <= 0;
+            write_resp      <= 0;
+            write_valid     <= 1'b0;
+            wr_data_good    <= 1'b0;
+            wr_addr_good    <= 1'b0;
+            baud_div        <= C_BAUD_DIV;
+        end
+
+        else begin
+            // Latch write address
+            if (s_axi_awvalid & ~wr_addr_rdy & ~wr_addr_good) begin
+                wr_addr_rdy     <= 1'b1;
+                write_address   <= s_axi_awaddr;
+                wr_addr_good    <= 1'b1;
+            end
+            else begin
+                wr_addr_rdy     <= 1'b0;
+            end
+
+            // Latch write data
+            if (s_axi_wvalid & ~wr_data_rdy & ~wr_data_good) begin
+                wr_data_rdy     <= 1'b1;
+                write_data      <= s_axi_wdata;
+                wr_data_good    <= 1'b1;
+            end
+            else begin
+                wr_data_rdy     <= 1'b0;
+            end
+
+            // Write write data to register, only the
+            // baud divider is writable
+            if (wr_data_good & wr_addr_good) begin
+                write_valid     <= 1'b1;
+                wr_data_good    <= 1'b0;
+                wr_addr_good    <= 1'b0;
+                if (write_address[3:2] == BAUD_DIV_ADDR) begin
+                    write_resp  <= C_OKAY;
+                    baud_div    <= write_data[23:0];
+                end
+                else begin
+                    write_resp  <= C_SLV_ERR;
+                end
+            end
+            else if (write_valid & s_axi_bready) begin
+                write_valid <= 1'b0;
+            end
+        end
+    end
+
+    // Error counters
+    always @(posedge s_axi_aclk) begin
+        if (~s_axi_aresetn) begin
+            overrun_cnt     <= 0;
+            frame_err_cnt   <= 0;
+            noise_cnt       <= 0;
+        end
+
+        else begin
+            if (overrun) begin
+                overrun_cnt     <= overrun_cnt+1;
+            end
+            if (frame_err) begin
+                frame_err_cnt   <= frame_err_cnt+1;
+            end
+            if (noise_flg) begin
+                noise_cnt       <= noise_cnt+1;
+            end
+        end
+    end
+
     uart_rx #(
             .LSB_FIRST  (C_LSB_FIRST))
         midi_rx (
             .clk        (s_axi_aclk),
             .rst_n      (s_axi_aresetn),
             .i_data     (midi_in),
+            .baud_div   (baud_div),
             .o_data     (midi_out),
-            .rdy_flg    (word_vld)
+            .rdy_flg    (word_vld),
+            .frame_err  (frame_err),
+            .noise_flg  (noise_flg)
         );
 
     uart_fifo #(
@@ -127,9 +254,11 @@ module axi_uart_wrapper #(
             .rst_n          (s_axi_aresetn),
             .word_in        (midi_out),
             .word_in_valid  (word_vld),
-            .word_out_valid (rd_en),
+            .word_out_valid (fifo_pop),
             .word_out       (fifo_out),
-            .word_rdy       (midi_intr)
+            .word_rdy       (midi_intr),
+            .word_count     (fifo_count),
+            .overrun        (overrun)
         );
 
 
@@ -73,6 +73,24 @@
         localparam RC_RELEASE_ADDR  = 51;
         localparam MOD_TAU_ADDR     = 52;
 
+        // ENVELOPE ADDRESS, read only
+        localparam ENVELOPE_0_ADDR  = 64;
+        localparam ENVELOPE_1_ADDR  = 65;
+        localparam ENVELOPE_2_ADDR  = 66;
+        localparam ENVELOPE_3_ADDR  = 67;
+        localparam ENVELOPE_4_ADDR  = 68;
+        localparam ENVELOPE_5_ADDR  = 69;
+        localparam ENVELOPE_6_ADDR  = 70;
+        localparam ENVELOPE_7_ADDR  = 71;
+        localparam ENVELOPE_8_ADDR  = 72;
+        localparam ENVELOPE_9_ADDR  = 73;
+        localparam ENVELOPE_10_ADDR = 74;
+        localparam ENVELOPE_11_ADDR = 75;
+        localparam ENVELOPE_12_ADDR = 76;
+        localparam ENVELOPE_13_ADDR = 77;
+        localparam ENVELOPE_14_ADDR = 78;
+        localparam ENVELOPE_15_ADDR = 79;
+
     endpackage
 
 `endif
\ No newline at end of file
@@ -10,7 +10,9 @@
 // Description: This module infers a dual port BRAM based LUT used to store values
 // of cos. The bit-width is given by the WIDTH parameter and the LUT depth is given
 // by the DEPTH parameter. The LUT is initialized with a .mem file containing the
-// binary values to be stored in the LUT. This is referenced by INIT_VAL.
+// binary values to be stored in the LUT. This is referenced by INIT_VAL. The
+// table holds a quarter wave, generated by tools/lut_gen, and both ports read
+// the same BRAM so the modulator and carrier share one copy.
 //////////////////////////////////////////////////////////////////////////////////
 
 module cos_lut #(
@@ -20,8 +22,10 @@ module cos_lut #(
     ADDR_WIDTH  = 12    // Address width
     )(
     input   wire                    clk,
-    input   wire [ADDR_WIDTH-1:0]   addr,
-    output  reg  [WIDTH-1:0]        data_out
+    input   wire [ADDR_WIDTH-1:0]   addr_a,
+    input   wire [ADDR_WIDTH-1:0]   addr_b,
+    output  reg  [WIDTH-1:0]        data_a,
+    output  reg  [WIDTH-1:0]        data_b
     );
 
 // SIGNAL DECLARATION
@@ -34,7 +38,8 @@ module cos_lut #(
 
 // SYNCHRONOUS READS FROM LUT
     always@(posedge clk) begin
-        data_out <= lut[addr];
+        data_a <= lut[addr_a];
+        data_b <= lut[addr_b];
     end
 
 endmodule
\ No newline at end of file
@@ -65,8 +65,11 @@ module fixed_point_adder #
 
         // If the desired integer bits are greater than the result then
         // sign extend the result to provide the additional bits, no overflow
-        if (WI_O >= I_BITS+1)
-            data_out[WI_O+WF_O-1:WF_O] = {{WI_O-(I_BITS+1'b1),{i_out[I_BITS]}}, i_out};
+        if (WI_O > I_BITS+1)
+            data_out[WI_O+WF_O-1:WF_O] = {{WI_O-I_BITS-1{i_out[I_BITS]}}, i_out};
+
+        else if (WI_O == I_BITS+1)
+            data_out[WI_O+WF_O-1:WF_O] = i_out;
 
         // If the requested integer bits match the result, the pass the result.
         // If an overflow occurs then the wrapped value is passed through
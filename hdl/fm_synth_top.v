@@ -40,18 +40,28 @@ module fm_synth_top #(
     output  wire                        interrupt_out,
     output  wire                        s_clk,
     output  wire                        trig_out,
-    input   wire    [NUM_BITS-1:0]      mod_tau
+    input   wire    [NUM_BITS-1:0]      mod_tau,
+    output  wire    [`TOTAL_BITS-1:0]   envelope_out,
+    input   wire    [31:0]              s_axis_mix_tdata,
+    input   wire                        s_axis_mix_tvalid,
+    output  wire                        s_axis_mix_tready
     );
 
     localparam DEPTH = NUM_BRAM*1024;
     localparam WIDTH = 18;
+    localparam LUT_ADDR_WIDTH = $clog2(DEPTH);
 
     wire    [NUM_BITS-1:0]          carrier_word;
     wire    [NUM_BITS-1:0]          mod_word;
     wire    [NUM_BITS-1:0]          modulated_tuning_word;
     wire    [WI_OUT+WF_OUT-1:0]     car_out;
     wire    [WI_OUT+WF_OUT-1:0]     mod_sig;
+    wire    [LUT_ADDR_WIDTH-1:0]    mod_lut_addr;
+    wire    [LUT_ADDR_WIDTH-1:0]    car_lut_addr;
+    wire    [WIDTH-1:0]             mod_lut_data;
+    wire    [WIDTH-1:0]             car_lut_data;
     wire    [NUM_BITS_DAC-1:0]      final_word;
+    wire    [NUM_BITS_DAC-1:0]      final_word_mix;
     wire    [NUM_BITS_DAC-1:0]      final_word_vol;
     wire    [NUM_CHANNELS-1:0]      note_en;
     wire    [NUM_CHANNELS-1:0]      car_reg_en;
@@ -107,9 +117,22 @@ module fm_synth_top #(
             .trigger        (trig_out)
         );
 
+    // QUARTER WAVE TABLE SHARED BY BOTH OSCILLATORS
+    cos_lut #(
+            .INIT_VAL       (COS_LUT_VALUES),
+            .WIDTH          (WIDTH),
+            .DEPTH          (DEPTH),
+            .ADDR_WIDTH     (LUT_ADDR_WIDTH))
+        lut (
+            .clk            (clk),
+            .addr_a         (mod_lut_addr),
+            .addr_b         (car_lut_addr),
+            .data_a         (mod_lut_data),
+            .data_b         (car_lut_data)
+        );
+
     // GENERATE MODULATING SIGNAL
     note_gen #(
-            .COS_LUT_VALUES (COS_LUT_VALUES),
             .WIDTH          (WIDTH),
             .DEPTH          (DEPTH),
             .NUM_BITS       (NUM_BITS))
@@ -121,6 +144,8 @@ module fm_synth_top #(
             .acc_clr        (mod_acc_clr),
             .curr_note      (curr_note),
             .tuning_word    (mod_word),
+            .lut_addr       (mod_lut_addr),
+            .lut_data       (mod_lut_data),
             .wave_out       (mod_sig),
             .trig_out       ()
         );
@@ -147,7 +172,6 @@ module fm_synth_top #(
 
     // GENERATE FM SIGNAL
     note_gen #(
-            .COS_LUT_VALUES (COS_LUT_VALUES),
             .WIDTH          (WIDTH),
             .DEPTH          (DEPTH),
             .NUM_BITS       (NUM_BITS))
@@ -159,6 +183,8 @@ module fm_synth_top #(
             .acc_clr        (0),
             .curr_note      (curr_note),
             .tuning_word    (modulated_tuning_word),
+            .lut_addr       (car_lut_addr),
+            .lut_data       (car_lut_data),
             .wave_out       (car_out),
             .trig_out       ()
         );
@@ -180,7 +206,22 @@ module fm_synth_top #(
             .decay_tau      (decay_tau),
             .release_tau    (release_tau),
             .note_out       (final_word),
-            .available      (available)
+            .available      (available),
+            .envelope_out   (envelope_out)
+        );
+
+    // MIX IN THE SOFTWARE VOICES
+    stream_mix #(
+            .NUM_BITS_DAC   (NUM_BITS_DAC))
+        soft_voices (
+            .clk            (clk),
+            .rst            (rst),
+            .ready          (ready),
+            .word_in        (final_word),
+            .word_out       (final_word_mix),
+            .s_axis_tdata   (s_axis_mix_tdata),
+            .s_axis_tvalid  (s_axis_mix_tvalid),
+            .s_axis_tready  (s_axis_mix_tready)
         );
 
     // SCALE MODULATING SIGNAL TO USER DEFINED VALUED
@@ -192,7 +233,7 @@ module fm_synth_top #(
             .WI_O   (10),
             .WF_O   (14))
         volume (
-            .in_1       (final_word),
+            .in_1       (final_word_mix),
             .in_2       (volume_reg),
             .data_out   (final_word_vol),
             .ovf        ()
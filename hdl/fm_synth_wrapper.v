@@ -16,7 +16,7 @@ module fm_synth_wrapper #(
     parameter   COS_LUT_VALUES  = "C:/Users/mfall/Documents/School/year_4/senior_design/v_3/hdl/lut.mem",
     // parameter   COS_LUT_VALUES  = "lut.mem",
     parameter   NUM_CHANNELS    = 16,
-    parameter   NUM_REG         = 52,
+    parameter   NUM_REG         = 80,
     parameter   LATENCY         = 3,
     parameter   NUM_BRAM        = 32,
     parameter   NUM_BITS        = 32,
@@ -24,7 +24,9 @@ module fm_synth_wrapper #(
     parameter   WF_OUT          = 16,
     parameter   NUM_BITS_DAC    = 24
     )(
-    // Clock and reset
+    // Clock and reset, the mix stream runs on the AXI clock
+    (* X_INTERFACE_INFO = "xilinx.com:signal:clock:1.0 s_axi_aclk CLK" *)
+    (* X_INTERFACE_PARAMETER = "ASSOCIATED_BUSIF s_axi:s_axis_mix, ASSOCIATED_RESET s_axi_aresetn" *)
     input   wire                            s_axi_aclk,
     input   wire                            s_axi_aresetn,
     // Write address channel
@@ -57,7 +59,11 @@ module fm_synth_wrapper #(
     output  wire                            serial_data,
     output  wire                            interrupt,
     output  wire                            s_clk,
-    output  wire                            trig_out
+    output  wire                            trig_out,
+    // Software voice stream
+    input   wire    [31:0]                  s_axis_mix_tdata,
+    input   wire                            s_axis_mix_tvalid,
+    output  wire                            s_axis_mix_tready
     );
 
     localparam  NUM_BITS_TAU = 16;
@@ -65,6 +71,7 @@ module fm_synth_wrapper #(
     wire    [NUM_CHANNELS*NUM_BITS-1:0] carriers;
     wire    [NUM_CHANNELS*NUM_BITS-1:0] modulators;
     wire    [NUM_CHANNELS*NUM_BITS-1:0] velocities;
+    wire    [NUM_CHANNELS*NUM_BITS-1:0] envelopes;
     wire    [NUM_BITS_TAU-1:0]          attack_tau;
     wire    [NUM_BITS_TAU-1:0]          decay_tau;
     wire    [NUM_BITS_TAU-1:0]          release_tau;
@@ -113,7 +120,8 @@ module fm_synth_wrapper #(
             .volume_reg     (volume_reg),
             .wave_sel       (wave_sel),
             .mod_tau        (mod_tau),
-            .mod_enable     (mod_enable)
+            .mod_enable     (mod_enable),
+            .envelope_in    (envelopes)
         );
 
 
@@ -146,7 +154,11 @@ module fm_synth_wrapper #(
             .interrupt_out  (interrupt),
             .s_clk          (s_clk),
             .trig_out       (trig_out),
-            .mod_tau        (mod_tau)
+            .mod_tau        (mod_tau),
+            .envelope_out   (envelopes),
+            .s_axis_mix_tdata   (s_axis_mix_tdata),
+            .s_axis_mix_tvalid  (s_axis_mix_tvalid),
+            .s_axis_mix_tready  (s_axis_mix_tready)
         );
 
     // Dump waves
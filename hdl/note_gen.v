@@ -10,7 +10,6 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 module note_gen #(
-    parameter   COS_LUT_VALUES  = "lut.mem",
     parameter   WIDTH           = 18,
     parameter   DEPTH           = 4096,
     parameter   NUM_BITS        = 32,
@@ -23,6 +22,8 @@ module note_gen #(
     input   wire    [NUM_CHANNELS-1:0]      acc_clr,
     input   wire    [NUM_CHANNELS-1:0]      curr_note,
     input   wire    [NUM_BITS-1:0]          tuning_word,
+    output  wire    [`ADDR_WIDTH-1:0]       lut_addr,
+    input   wire    [WIDTH-1:0]             lut_data,
     output  reg     [WIDTH-1:0]             wave_out,
     output  wire                            trig_out
     );
@@ -33,8 +34,6 @@ module note_gen #(
 
     wire    [NUM_BITS-1:0]          phi_out;
     wire    [`ADDR_WIDTH+1:0]       addr;
-    wire    [`ADDR_WIDTH-1:0]       addr_mapped;
-    wire    [WIDTH-1:0]             lut_out;
     wire    [WIDTH-1:0]             sin_out;
     wire    [WIDTH-1:0]             sqr_out;
     wire    [WIDTH-1:0]             tri_out;
@@ -79,20 +78,9 @@ module note_gen #(
             .DEPTH      (DEPTH))
         quad_logic (
             .addr_in    (addr),
-            .data_in    (lut_out),
-            .addr_out   (addr_mapped),
+            .data_in    (lut_data),
+            .addr_out   (lut_addr),
             .data_out   (sin_out)
         );
 
-    cos_lut #(
-            .INIT_VAL   (COS_LUT_VALUES),
-            .WIDTH      (WIDTH),
-            .DEPTH      (DEPTH),
-            .ADDR_WIDTH (`ADDR_WIDTH))
-        lut (
-            .clk        (clk),
-            .addr       (addr_mapped),
-            .data_out   (lut_out)
-        );
-
 endmodule
\ No newline at end of file
@@ -29,12 +29,15 @@ module note_registers #(
     input   wire    [NUM_BITS_TAU-1:0]  decay_tau,
     input   wire    [NUM_BITS_TAU-1:0]  release_tau,
     output  wire    [NUM_BITS_OUT-1:0]  note_out,
-    output  wire    [NUM_CHANNELS-1:0]  available
+    output  wire    [NUM_CHANNELS-1:0]  available,
+    output  wire    [32*NUM_CHANNELS-1:0] envelope_out
     );
 
     reg     [NUM_BITS_IN-1:0]   notes           [0:NUM_CHANNELS-1];
     wire    [31:0]              velocities      [0:NUM_CHANNELS-1];
     wire    [NUM_BITS_IN-1:0]   notes_shaped    [0:NUM_CHANNELS-1];
+    wire    [23:0]              envelopes       [0:NUM_CHANNELS-1];
+    wire    [1:0]               stages          [0:NUM_CHANNELS-1];
     wire    [`TOTAL_BITS-1:0]   notes_shaped_flat;
     reg     [NUM_BITS_OUT-1:0]  note_out_reg;
     wire    [NUM_BITS_OUT-1:0]  note_out_i;
@@ -67,6 +70,8 @@ module note_registers #(
         for (j=0; j<NUM_CHANNELS; j=j+1) begin
             assign notes_shaped_flat[NUM_BITS_IN*(j+1)-1:NUM_BITS_IN*j] = notes_shaped[j];
             assign velocities[j] = velocity_in[32*(j+1)-1:32*j];
+            // Envelope word, stage in 25:24 and level in 23:0
+            assign envelope_out[32*(j+1)-1:32*j] = {6'b000000, stages[j], envelopes[j]};
 
             amp_shaper #(
                     .NUM_BITS_TAU   (NUM_BITS_TAU),
@@ -82,7 +87,9 @@ module note_registers #(
                     .release_tau    (release_tau),
                     .word_in        (notes[j]),
                     .word_out       (notes_shaped[j]),
-                    .available      (available[j])
+                    .available      (available[j]),
+                    .envelope_out   (envelopes[j]),
+                    .stage          (stages[j])
                 );
         end
     endgenerate
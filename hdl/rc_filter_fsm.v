@@ -37,7 +37,8 @@ module rc_filter_fsm #(
     input   wire        [TAU_BITS-1:0]  decay_tau,
     input   wire        [TAU_BITS-1:0]  release_tau,
     output  wire                        available,
-    output  wire signed [ENV_BITS-1:0]  envelope
+    output  wire signed [ENV_BITS-1:0]  envelope,
+    output  wire        [1:0]           stage
     );
 
     // CONSTANTS
@@ -46,6 +47,11 @@ module rc_filter_fsm #(
     localparam                      S_IDLE          = 1'b0;
     localparam                      S_ACTIVE        = 1'b1;
 
+    // Stage reported to the firmware
+    localparam      [1:0]           STAGE_IDLE      = 2'd0;
+    localparam      [1:0]           STAGE_ATTACK    = 2'd1;
+    localparam      [1:0]           STAGE_RELEASE   = 2'd2;
+
     reg                             avail;
     reg                             state;
     reg     signed  [ENV_BITS-1:0]  env_delay;
@@ -63,6 +69,7 @@ module rc_filter_fsm #(
     assign  sum         = step_delay - env_delay;
     assign  envelope    = product + env_delay;
     assign  available   = avail;
+    assign  stage       = (state == S_IDLE) ? STAGE_IDLE : (en ? STAGE_ATTACK : STAGE_RELEASE);
 
     always @(posedge clk) begin
         if (rst) begin
@@ -89,11 +96,14 @@ module rc_filter_fsm #(
                         env_delay   <= envelope;
                     end
 
+                    // A held note moves at the attack rate, a released one at the release rate
                     if (en) begin
                         step_delay  <= {attack, 8'h00};
+                        tau         <= {8'h00, attack_tau};
                     end
                     else begin
                         step_delay  <= 0;
+                        tau         <= {8'h00, release_tau};
                     end
 
                     if (envelope < MIN) begin
@@ -0,0 +1,66 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: agent
+//
+// Design Name: FM SYNTHESIZER
+// Module Name: stream_mix
+// Tool Versions: Vivado 2020.2
+//
+// Description: Mixes samples streamed in over AXI-Stream, the software voices
+// rendered on the second core, into the summed fabric voices. Samples are
+// 8.16 like the output of note_registers, one per I2S word, and sit in a
+// FIFO so the DMA can deliver them in bursts. tready drops when the FIFO is
+// full, which paces the DMA, and an empty FIFO mixes in silence.
+//////////////////////////////////////////////////////////////////////////////////
+
+module stream_mix #(
+    parameter   NUM_BITS_DAC    = 24,
+    parameter   FIFO_DEPTH      = 128
+    )(
+    input   wire                        clk,
+    input   wire                        rst,
+    input   wire                        ready,
+    input   wire    [NUM_BITS_DAC-1:0]  word_in,
+    output  wire    [NUM_BITS_DAC-1:0]  word_out,
+    input   wire    [31:0]              s_axis_tdata,
+    input   wire                        s_axis_tvalid,
+    output  wire                        s_axis_tready
+    );
+
+    wire    [NUM_BITS_DAC-1:0]          sample;
+    wire    [$clog2(FIFO_DEPTH):0]      count;
+
+    assign s_axis_tready = (count < FIFO_DEPTH) ? 1 : 0;
+
+    // Popped entries are cleared, so an empty FIFO reads 0
+    uart_fifo #(
+            .NUM_BITS       (NUM_BITS_DAC),
+            .FIFO_DEPTH     (FIFO_DEPTH))
+        sample_fifo (
+            .clk            (clk),
+            .rst_n          (~rst),
+            .word_in        (s_axis_tdata[NUM_BITS_DAC-1:0]),
+            .word_in_valid  (s_axis_tvalid),
+            .word_out_valid (ready),
+            .word_out       (sample),
+            .word_rdy       (),
+            .word_count     (count),
+            .overrun        ()
+        );
+
+    fixed_point_adder #(
+            .WI_1   (8),
+            .WF_1   (16),
+            .WI_2   (8),
+            .WF_2   (16),
+            .WI_O   (8),
+            .WF_O   (16))
+        mix (
+            .in_1       (word_in),
+            .in_2       (sample),
+            .data_out   (word_out),
+            .ovf        ()
+        );
+
+endmodule
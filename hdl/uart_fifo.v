@@ -20,20 +20,28 @@ module uart_fifo # (
     input   wire                    word_in_valid,
     input   wire                    word_out_valid,
     output  wire    [NUM_BITS-1:0]  word_out,
-    output  reg                     word_rdy
+    output  reg                     word_rdy,
+    output  wire    [$clog2(FIFO_DEPTH):0]  word_count,
+    output  wire                    overrun
     );
     
     reg [NUM_BITS-1:0]              fifo [0:FIFO_DEPTH-1];
     reg [$clog2(FIFO_DEPTH)-1:0]    write_ptr;
     reg [$clog2(FIFO_DEPTH)-1:0]    read_ptr;
-    reg                             wrap;
+    reg [$clog2(FIFO_DEPTH):0]      count;
     wire                            full;
     wire                            empty;
+    wire                            push;
+    wire                            pop;
     integer                         i;
     
     assign  word_out    = fifo[read_ptr];
-    assign  empty       = (write_ptr == read_ptr) && ~wrap ? 1 : 0;
-    assign  full        = (write_ptr == read_ptr) && wrap  ? 1 : 0;
+    assign  empty       = (count == 0) ? 1 : 0;
+    assign  full        = (count == FIFO_DEPTH) ? 1 : 0;
+    assign  push        = word_in_valid & ~full;
+    assign  pop         = word_out_valid & ~empty;
+    assign  word_count  = count;
+    assign  overrun     = word_in_valid & full;
     
     always @(posedge clk) begin
         if(~rst_n) begin
@@ -42,38 +50,41 @@ module uart_fifo # (
             end
             write_ptr   <= 0;
             read_ptr    <= 0;
-            wrap        <= 0;
+            count       <= 0;
             word_rdy    <= 0;
         end
 
         else begin
             word_rdy    <= 0;
-            if (word_in_valid) begin
-                if (~full) begin
-                    word_rdy    <= 1;
-                    fifo[write_ptr] <= word_in;
-                    if (write_ptr == FIFO_DEPTH-1) begin
-                        write_ptr   <= 0;
-                        wrap        <= 1;
-                    end
-                    else begin
-                        write_ptr   <= write_ptr+1;
-                    end
+            if (push) begin
+                word_rdy    <= 1;
+                fifo[write_ptr] <= word_in;
+                if (write_ptr == FIFO_DEPTH-1) begin
+                    write_ptr   <= 0;
+                end
+                else begin
+                    write_ptr   <= write_ptr+1;
                 end
             end
 
-            if (word_out_valid) begin
-                if (~empty) begin
-                    fifo[read_ptr]  <= 0;
-                    if (read_ptr == FIFO_DEPTH-1) begin
-                        read_ptr    <= 0;
-                        wrap        <= 0;
-                    end
-                    else begin
-                        read_ptr    <= read_ptr+1;
-                    end
+            if (pop) begin
+                fifo[read_ptr]  <= 0;
+                if (read_ptr == FIFO_DEPTH-1) begin
+                    read_ptr    <= 0;
+                end
+                else begin
+                    read_ptr    <= read_ptr+1;
                 end
             end
+
+            // Occupancy counter, also correct when a word is
+            // written and read in the same cycle
+            if (push & ~pop) begin
+                count   <= count+1;
+            end
+            else if (pop & ~push) begin
+                count   <= count-1;
+            end
         end
     end
     
@@ -22,6 +22,18 @@
 //      baud rate           = 31.250 Kbs
 //      clk cycles per bit  = 1044
 //      sample point        = 522.5
+//
+//      The bit period is set at runtime by baud_div, clock cycles per bit
+//      in 16.8 fixed point. The fraction is carried from bit to bit so
+//      non-integer dividers used for 1-3 Mbaud do not accumulate error:
+//
+//      clk frequency       = 32.653061 MHz
+//      baud rate           = 3 Mbs
+//      clk cycles per bit  = 10.884     (baud_div = 0x000AE2)
+//
+//      Each sample is the majority of three consecutive clocks, a sample
+//      where the three disagree is flagged as noise. A low stop bit is
+//      flagged as a framing error and the byte is dropped.
 // 
 //////////////////////////////////////////////////////////////////////////////////
 module uart_rx # (
@@ -30,57 +42,85 @@ module uart_rx # (
     input   wire            clk,            //clock signal
     input   wire            rst_n,            //reset line
     input   wire            i_data,         //incoming serial data line
+    input   wire    [23:0]  baud_div,       //clock cycles per bit, 16.8 fixed point
     output  reg     [7:0]   o_data,         //output 8 bit data register
-    output  wire            rdy_flg         //register ready to be read
+    output  wire            rdy_flg,        //register ready to be read
+    output  reg             frame_err,      //stop bit was low
+    output  reg             noise_flg       //samples disagreed within a bit
     );
     
-    localparam  SAMPLE_POINT    = 522;              //number of clock cycles until sample point
-    localparam  BIT_COUNT       = 2*SAMPLE_POINT;   //number of clock cycles in one UART bit
     localparam  NUM_BITS        = 8;                //number of bits in UART word
+    localparam  ONE             = 24'h000100;       //one clock cycle in 16.8 fixed point
     
-    localparam  s_IDLE          = 2'b00;    //IDLE state, waiting to receive new data
-    localparam  s_START         = 2'b01;    //START state, verify that start bit is valid
-    localparam  s_RX            = 2'b10;    //RX state, receive data 
-    localparam  s_DONE          = 2'b11;    //DONE state, wait for data to be read
+    localparam  s_IDLE          = 3'b000;   //IDLE state, waiting to receive new data
+    localparam  s_START         = 3'b001;   //START state, verify that start bit is valid
+    localparam  s_RX            = 3'b010;   //RX state, receive data 
+    localparam  s_STOP          = 3'b011;   //STOP state, verify the stop bit
+    localparam  s_BREAK         = 3'b100;   //BREAK state, wait for the line to return high
     
     reg [NUM_BITS-1:0]  data;               //register to hold recieved data
-    reg [1:0]           state;              //register to hold current state
-    reg [13:0]          bit_cnt;            //counter to count clock cycles per bit
+    reg [2:0]           state;              //register to hold current state
+    reg [23:0]          bit_cnt;            //clock cycles into the current bit, 16.8 fixed point
     reg [3:0]           bits_rx;            //counter to count number of bits received
     reg                 rdy;                //receive complete and ready to be read
+    reg [1:0]           sync;               //synchronizer for the asynchronous input
+    reg [2:0]           samples;            //last three synchronized samples
+    wire                rx_bit;             //majority of the last three samples
+    wire                rx_noisy;           //last three samples disagree
+    wire [23:0]         half_div;           //half a bit period
     
-    assign  rdy_flg = rdy;
+    assign  rdy_flg     = rdy;
+    assign  rx_bit      = (samples[0] & samples[1]) | (samples[0] & samples[2]) | (samples[1] & samples[2]);
+    assign  rx_noisy    = ~(&samples) & (|samples);
+    assign  half_div    = {1'b0, baud_div[23:1]};
     
+    // Oversample the input at the clock rate
     always @(posedge clk) begin
         if(~rst_n) begin
-            state   <= s_IDLE;
-            data    <= 0;
-            bit_cnt <= 0;
-            bits_rx <= 0;
-            rdy     <= 0;
-            o_data  <= 0;
+            sync    <= 2'b11;
+            samples <= 3'b111;
+        end
+        else begin
+            sync    <= {sync[0], i_data};
+            samples <= {samples[1:0], sync[1]};
+        end
+    end
+    
+    always @(posedge clk) begin
+        if(~rst_n) begin
+            state       <= s_IDLE;
+            data        <= 0;
+            bit_cnt     <= 0;
+            bits_rx     <= 0;
+            rdy         <= 0;
+            o_data      <= 0;
+            frame_err   <= 0;
+            noise_flg   <= 0;
         end
 
         else begin
+            rdy         <= 0;
+            frame_err   <= 0;
+            noise_flg   <= 0;
+
             case(state) 
                 s_IDLE : begin
                     bit_cnt <= 0;
                     bits_rx <= 0;
-                    rdy     <= 0;
-                    if(~i_data)
+                    if(~rx_bit)
                         state   <= s_START;
                     else
                         state   <= s_IDLE;
                 end
 
                 s_START : begin
-                    bit_cnt <= bit_cnt+1;
+                    bit_cnt <= bit_cnt+ONE;
                     state   <= s_START;
 
-                    if(bit_cnt >= SAMPLE_POINT) begin
-                        if(~i_data) begin
+                    if(bit_cnt >= half_div) begin
+                        if(~rx_bit) begin
                             state   <= s_RX;
-                            bit_cnt <= 0;
+                            bit_cnt <= bit_cnt+ONE-half_div;
                         end
 
                         else begin
@@ -91,35 +131,53 @@ module uart_rx # (
                 
                 s_RX : begin
                     state   <= s_RX;
-                    if(bits_rx < NUM_BITS) begin
+                    bit_cnt <= bit_cnt+ONE;
 
-                        if(bit_cnt==BIT_COUNT) begin
-                            if (LSB_FIRST == 1) begin
-                                data[bits_rx]   <= i_data;
-                            end
-
-                            else if (LSB_FIRST == 0) begin
-                                data[(NUM_BITS-1)-bits_rx] <= i_data;
-                            end
+                    if(bit_cnt >= baud_div) begin
+                        if (LSB_FIRST == 1) begin
+                            data[bits_rx]   <= rx_bit;
+                        end
 
-                            bit_cnt         <= 0;
-                            bits_rx         <= bits_rx+1;
+                        else if (LSB_FIRST == 0) begin
+                            data[(NUM_BITS-1)-bits_rx] <= rx_bit;
                         end
 
-                        else begin
-                            bit_cnt <= bit_cnt+1;
+                        noise_flg   <= rx_noisy;
+                        bit_cnt     <= bit_cnt+ONE-baud_div;
+                        bits_rx     <= bits_rx+1;
+
+                        if(bits_rx == NUM_BITS-1) begin
+                            state   <= s_STOP;
                         end
                     end
+                end
 
-                    else begin
-                        state   <= s_DONE;
+                // Return to idle in the middle of the stop bit
+                // so the next start bit is caught on its edge
+                s_STOP : begin
+                    state   <= s_STOP;
+                    bit_cnt <= bit_cnt+ONE;
+
+                    if(bit_cnt >= baud_div) begin
+                        noise_flg   <= rx_noisy;
+                        if(rx_bit) begin
+                            rdy     <= 1;
+                            o_data  <= data;
+                            state   <= s_IDLE;
+                        end
+
+                        else begin
+                            frame_err   <= 1;
+                            state       <= s_BREAK;
+                        end
                     end
                 end
 
-                s_DONE : begin
-                    rdy     <= 1;
-                    o_data  <= data;
-                    state   <= s_IDLE;
+                s_BREAK : begin
+                    if(rx_bit)
+                        state   <= s_IDLE;
+                    else
+                        state   <= s_BREAK;
                 end
 
                  default : state <= s_IDLE;
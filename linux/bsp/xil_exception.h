@@ -0,0 +1,21 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Interrupt masking, the host loop runs every handler on one
+// thread so both are no-ops
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XIL_EXCEPTION_H
+#define XIL_EXCEPTION_H
+
+#include "xil_types.h"
+
+    static inline void Xil_ExceptionEnable(void) {
+    }
+
+    static inline void Xil_ExceptionDisable(void) {
+    }
+
+#endif
@@ -0,0 +1,36 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Register access through the mapped UIO windows, a plain volatile
+// load or store with no system call. An address outside every open window
+// is dropped on write and reads as 0
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+#include "uio.hpp"
+
+    static inline void Xil_Out32(UINTPTR addr, u32 value) {
+        volatile u32 *reg = uio_reg(addr);
+
+        if (reg == NULL) {
+            return;
+        }
+        *reg = value;
+        if (uio_latency.armed) {
+            uio_latency_stamp();
+        }
+    }
+
+    static inline u32 Xil_In32(UINTPTR addr) {
+        volatile u32 *reg = uio_reg(addr);
+
+        return (reg == NULL) ? 0 : *reg;
+    }
+
+#endif
@@ -0,0 +1,18 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Debug prints go to stderr, outbyte carries sysex replies and
+// looper exports to the midi output descriptor
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XIL_PRINTF_H
+#define XIL_PRINTF_H
+
+#include "xil_types.h"
+
+    void xil_printf(const char8 *ctrl1, ...);
+    void outbyte(char8 c);
+
+#endif
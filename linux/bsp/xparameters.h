@@ -0,0 +1,17 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Physical addresses of the block design. Under Linux they are
+// only keys, uio.hpp turns them into offsets into the mapped UIO windows
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+    #define XPAR_FM_SYNTH_WRAPPER_0_BASEADDR        0x43C10000
+    #define XPAR_AXI_UART_WRAPPER_0_BASEADDR        0x43C00000
+    #define XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ     666666687
+
+#endif
@@ -0,0 +1,28 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Global timer read from CLOCK_MONOTONIC, scaled to the bare
+// metal count rate so the looper timing is unchanged
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XTIME_L_H
+#define XTIME_L_H
+
+#include <time.h>
+#include "xil_types.h"
+#include "xparameters.h"
+
+    typedef u64 XTime;
+
+    #define COUNTS_PER_SECOND   (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+
+    static inline void XTime_GetTime(XTime *Xtime_Global) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        *Xtime_Global = (XTime) now.tv_sec * COUNTS_PER_SECOND
+                      + (XTime) now.tv_nsec * COUNTS_PER_SECOND / 1000000000ULL;
+    }
+
+#endif
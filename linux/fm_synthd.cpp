@@ -0,0 +1,166 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: The synth firmware as a Linux process. The synth and midi uart
+// register spaces are mapped through UIO and driven with plain loads and
+// stores, interrupts arrive by polling the UIO descriptors.
+//
+//      fm_synthd [-s synth] [-u uart] [-m midi] [-o midi] [-p file] [-r prio] [-l sec] [-F]
+//
+//      -s  : synth UIO, device tree name or /dev/uioN (fm_synth_wrapper)
+//      -u  : midi uart UIO, or none to leave it to the midi input (axi_uart_wrapper)
+//      -m  : midi input, ALSA raw midi node, tty or - for stdin (none)
+//      -o  : midi output for sysex replies, defaults to the input node
+//      -p  : keep the last state in this file, it stands in for the QSPI flash
+//      -r  : run SCHED_FIFO at this priority with memory locked
+//      -l  : print the latency stats every sec seconds, they also print on exit.
+//            They time poll returning to the first register write, the
+//            kernel's interrupt to wake up time is not measured
+//      -F  : fake windows in memory, a dry run without the fabric
+//
+// The device tree needs the two wrappers bound to uio_pdrv_genirq, for example
+// compatible = "generic-uio" with uio_pdrv_genirq.of_id=generic-uio on the
+// kernel command line.
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "xparameters.h"
+#include "host_loop.hpp"
+#include "storage_file.hpp"
+
+    // Register space of each wrapper, the size a fake window maps
+    #define SYNTH_SPAN  0x1000
+    #define UART_SPAN   0x1000
+
+static volatile sig_atomic_t running = 1;
+
+    static void stop(int) {
+        running = 0;
+        return;
+    }
+
+    static int usage(const char *name) {
+        fprintf(stderr, "usage: %s [-s synth] [-u uart|none] [-m midi|-] [-o midi] "
+                        "[-p file] [-r prio] [-l sec] [-F]\n", name);
+        return 1;
+    }
+
+int main(int argc, char **argv) {
+    const char *synth_dev = "fm_synth_wrapper";
+    const char *uart_dev = "axi_uart_wrapper";
+    const char *midi_in_dev = NULL;
+    const char *midi_out_dev = NULL;
+    const char *state_file = NULL;
+    int prio = 0;
+    int report_sec = 0;
+    bool fake = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:u:m:o:p:r:l:F")) != -1) {
+        switch (opt) {
+            case 's' : synth_dev = optarg;          break;
+            case 'u' : uart_dev = optarg;           break;
+            case 'm' : midi_in_dev = optarg;        break;
+            case 'o' : midi_out_dev = optarg;       break;
+            case 'p' : state_file = optarg;         break;
+            case 'r' : prio = atoi(optarg);         break;
+            case 'l' : report_sec = atoi(optarg);   break;
+            case 'F' : fake = true;                 break;
+            default  : return usage(argv[0]);
+        }
+    }
+
+    if (!strcmp(uart_dev, "none")) {
+        uart_dev = NULL;
+    }
+
+    // Map the register windows
+    if (fake) {
+        if (uio_open_fake(uio_synth, "fm_synth", XPAR_FM_SYNTH_WRAPPER_0_BASEADDR, SYNTH_SPAN) < 0) {
+            return 1;
+        }
+        if (uart_dev && uio_open_fake(uio_uart, "midi_uart", XPAR_AXI_UART_WRAPPER_0_BASEADDR, UART_SPAN) < 0) {
+            return 1;
+        }
+    }
+    else {
+        if (uio_open(uio_synth, synth_dev, XPAR_FM_SYNTH_WRAPPER_0_BASEADDR) < 0) {
+            return 1;
+        }
+        if (uart_dev && uio_open(uio_uart, uart_dev, XPAR_AXI_UART_WRAPPER_0_BASEADDR) < 0) {
+            return 1;
+        }
+    }
+
+    // Open the midi ports, a raw midi node is read and written on one descriptor
+    int midi_in = -1;
+    int midi_out = -1;
+    if (midi_in_dev) {
+        if (!strcmp(midi_in_dev, "-")) {
+            midi_in = STDIN_FILENO;
+        }
+        else {
+            midi_in = open(midi_in_dev, (midi_out_dev ? O_RDONLY : O_RDWR) | O_NONBLOCK | O_CLOEXEC);
+            if (midi_in < 0) {
+                perror(midi_in_dev);
+                return 1;
+            }
+            if (!midi_out_dev) {
+                midi_out = midi_in;
+            }
+        }
+    }
+    if (midi_out_dev) {
+        midi_out = open(midi_out_dev, O_WRONLY | O_CLOEXEC);
+        if (midi_out < 0) {
+            perror(midi_out_dev);
+            return 1;
+        }
+    }
+
+    if (prio > 0) {
+        struct sched_param param;
+        param.sched_priority = prio;
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0 || sched_setscheduler(0, SCHED_FIFO, &param) < 0) {
+            perror("realtime");
+        }
+    }
+
+    if (state_file && storage_file_open(state_file) < 0) {
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    host_init(midi_in, midi_out);
+
+    time_t last_report = time(NULL);
+    while (running) {
+        if (host_service(HOST_POLL_MS) < 0) {
+            break;
+        }
+
+        if (report_sec > 0 && time(NULL) - last_report >= report_sec) {
+            last_report = time(NULL);
+            uio_latency_report(stderr);
+        }
+    }
+
+    uio_latency_report(stderr);
+    uio_close(uio_uart);
+    uio_close(uio_synth);
+    storage_file_close();
+
+return 0;
+}
@@ -0,0 +1,194 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Interrupt handlers and poll loop of the hosted firmware, see
+// host_loop.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "xil_io.h"
+#include "xil_printf.h"
+#include "xil_exception.h"
+#include "constants.hpp"
+#include "linked_list.hpp"
+#include "functions.hpp"
+#include "coalesce.hpp"
+#include "midi_parser.hpp"
+#include "looper.hpp"
+#include "telemetry.hpp"
+#include "recorder.hpp"
+#include "midi_clock.hpp"
+#include "arpeggiator.hpp"
+#include "last_state.hpp"
+#include "zones.hpp"
+#include "host_loop.hpp"
+
+static int midi_in_fd = -1;
+static int midi_out_fd = -1;
+
+    void xil_printf(const char8 *ctrl1, ...) {
+        va_list args;
+        va_start(args, ctrl1);
+        vfprintf(stderr, ctrl1, args);
+        va_end(args);
+        return;
+    }
+
+    // Sysex replies and looper exports leave on the midi output
+    void outbyte(char8 c) {
+        if (midi_out_fd >= 0) {
+            while (write(midi_out_fd, &c, 1) < 0 && errno == EINTR) {
+            }
+        }
+        return;
+    }
+
+    // One midi byte, recorded with the parser states either side of it.
+    // Real time bytes take the clock fast path as UART_IRQ_Handler
+    static void host_midi_byte(unsigned char x, XTime t) {
+        enum states before = live_parser.get_state();
+
+        if (x >= MIDI_CLOCK) {
+            tempo.realtime(x, t);
+        }
+        else {
+            looper.capture(x);
+            live_parser.parse(x);
+        }
+        recorder.log(RECORDER_MIDI, x, before | (live_parser.get_state() << 8));
+        return;
+    }
+
+    // Windows must be open, midi_in or midi_out may be -1
+    void host_init(int midi_in, int midi_out) {
+        midi_in_fd = midi_in;
+        midi_out_fd = midi_out;
+
+        synth_init(CTRL_INIT);
+        if (uio_synth.fd >= 0) {
+            uio_enable(uio_synth);
+        }
+        if (uio_uart.fd >= 0) {
+            uio_enable(uio_uart);
+        }
+        telemetry.ready();
+        return;
+    }
+
+    // One release pulse per count, as Synth_IRQ_Handler
+    void host_synth_irq(unsigned int count) {
+        for (unsigned int n=0; n<count; ++n) {
+            XTime start = telemetry.enter();
+            channels.make_available(0);
+            telemetry.leave(TELEMETRY_IRQ_SYNTH, start);
+        }
+        return;
+    }
+
+    // Drain the uart fifo, as UART_IRQ_Handler
+    void host_uart_irq() {
+        unsigned int rx_word;
+        unsigned int status;
+        XTime start = telemetry.enter();
+
+        status = Xil_In32(UART_STATUS_ADDR);
+        if (UART_FIFO_LEVEL(status) > telemetry.count.uart_fifo_irq_peak) {
+            telemetry.count.uart_fifo_irq_peak = UART_FIFO_LEVEL(status);
+        }
+        telemetry.count.uart_overruns = UART_OVERRUNS(status);
+
+        rx_word = Xil_In32(UART_ADDR);
+        while (rx_word & UART_DATA_VALID) {
+            host_midi_byte((unsigned char) rx_word, start);
+            rx_word = Xil_In32(UART_ADDR);
+        }
+        telemetry.leave(TELEMETRY_IRQ_UART, start);
+        return;
+    }
+
+    // Counted as uart interrupts, the midi input stands in for the uart
+    void host_midi_bytes(const unsigned char *bytes, int count) {
+        XTime start = telemetry.enter();
+
+        for (int n=0; n<count; ++n) {
+            host_midi_byte(bytes[n], start);
+        }
+        telemetry.leave(TELEMETRY_IRQ_UART, start);
+        return;
+    }
+
+    // Wait up to timeout_ms for an interrupt or midi input, run the
+    // handlers of everything ready and then the tick. Returns the
+    // number of ready sources, 0 on a timeout or -1 once the midi
+    // input closes or poll fails
+    int host_service(int timeout_ms) {
+        struct pollfd fds[3];
+        int nfds = 0;
+        int synth = -1;
+        int uart = -1;
+        int midi = -1;
+        int ready;
+
+        if (uio_synth.fd >= 0) {
+            synth = nfds;
+            fds[nfds].fd = uio_synth.fd;
+            fds[nfds].events = POLLIN;
+            nfds = nfds+1;
+        }
+        if (uio_uart.fd >= 0) {
+            uart = nfds;
+            fds[nfds].fd = uio_uart.fd;
+            fds[nfds].events = POLLIN;
+            nfds = nfds+1;
+        }
+        if (midi_in_fd >= 0) {
+            midi = nfds;
+            fds[nfds].fd = midi_in_fd;
+            fds[nfds].events = POLLIN;
+            nfds = nfds+1;
+        }
+
+        ready = poll(fds, nfds, timeout_ms);
+        if (ready < 0) {
+            return errno == EINTR ? 0 : -1;
+        }
+
+        // Time from here to the first register write of whatever woke us,
+        // the time the kernel took to wake us is not in it
+        if (ready > 0) {
+            uio_latency_arm();
+        }
+
+        if (synth >= 0 && (fds[synth].revents & POLLIN)) {
+            host_synth_irq(uio_take(uio_synth));
+        }
+
+        if (uart >= 0 && (fds[uart].revents & POLLIN)) {
+            uio_take(uio_uart);
+            host_uart_irq();
+        }
+
+        if (midi >= 0 && (fds[midi].revents & (POLLIN | POLLHUP | POLLERR))) {
+            unsigned char bytes[256];
+            ssize_t n = read(midi_in_fd, bytes, sizeof(bytes));
+            if (n > 0) {
+                host_midi_bytes(bytes, (int) n);
+            }
+            else if (n == 0 || errno != EAGAIN) {
+                midi_in_fd = -1;
+                ready = -1;
+            }
+        }
+
+        // A wake up that wrote nothing, running status or a partial message
+        uio_latency.armed = false;
+
+        synth_service();
+        return ready;
+    }
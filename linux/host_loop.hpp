@@ -0,0 +1,28 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: The firmware's interrupt handlers and main loop on one Linux
+// thread. host_service polls the synth and uart windows and the midi input
+// together and runs each handler when its descriptor is ready, then the work
+// main runs between interrupts. Any midi byte source works as input, an ALSA
+// raw midi node (/dev/snd/midiC1D0), a serial tty or a pipe.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_HOST_LOOP_HPP
+#define MYLIB_HOST_LOOP_HPP
+
+#include "uio.hpp"
+
+    // Wait between services when nothing arrives, bounds the control tick and looper delay
+    #define HOST_POLL_MS 1
+
+    void host_init(int midi_in, int midi_out);
+    int host_service(int timeout_ms);
+
+    void host_synth_irq(unsigned int count);
+    void host_uart_irq();
+    void host_midi_bytes(const unsigned char *bytes, int count);
+
+#endif
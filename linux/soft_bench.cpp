@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Throughput of the software voice kernel. Every voice is held
+// with a different note and blocks are rendered for a fixed stretch of audio,
+// the result is how many voices one core can keep up with at the I2S word
+// rate. Built with SSE4.1 on x86 and NEON when cross compiled, see Makefile.
+//
+//      soft_bench [-s seconds of audio] [-v voices]
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "soft_voice.hpp"
+#include "constants.hpp"
+
+    // Sample rate of the tuning words, one sample per I2S word
+    #define SOFT_RATE_HZ    128000
+
+    static double now() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec*1e-9;
+    }
+
+int main(int argc, char **argv) {
+    soft_engine engine;
+    int block[SOFT_BLOCK];
+    double seconds = 10;
+    unsigned int voices = SOFT_VOICES;
+    unsigned int count;
+    long long check = 0;
+    double start;
+    double elapsed;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:v:")) != -1) {
+        switch (opt) {
+            case 's' : seconds = atof(optarg); break;
+            case 'v' : voices = (unsigned int) atoi(optarg); break;
+            default  :
+                fprintf(stderr, "usage: %s [-s seconds] [-v voices]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (voices > SOFT_VOICES) {
+        voices = SOFT_VOICES;
+    }
+
+    engine.set_rates(RC_ATTACK_INIT, RC_RELEASE_INIT, MOD_TAU_INIT);
+    for (unsigned int v=0; v<voices; ++v) {
+        engine.note_on(v, TUNING_WORD[48+v], TUNING_WORD[36+v], VELOCITY_INIT);
+    }
+
+    count = (unsigned int) (seconds * SOFT_RATE_HZ / SOFT_BLOCK);
+    start = now();
+    for (unsigned int i=0; i<count; ++i) {
+        engine.render(block, SOFT_BLOCK);
+        check += block[i % SOFT_BLOCK];
+    }
+    elapsed = now() - start;
+
+    printf("kernel          : %s\n", soft_kernel());
+    printf("voices          : %u\n", voices);
+    printf("audio           : %.2f s in %.3f s\n", seconds, elapsed);
+    printf("real time load  : %.2f %%\n", 100 * elapsed / seconds);
+    printf("voices per core : %.1f\n", voices * seconds / elapsed);
+    printf("checksum        : %lld\n", check);
+    return 0;
+}
@@ -0,0 +1,97 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Storage area backed by a file, see storage_file.hpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "storage.hpp"
+#include "storage_file.hpp"
+
+static int storage_fd = -1;
+
+    // Grown to the full area, the new part erased
+    int storage_file_open(const char *path) {
+        unsigned char erased[STORAGE_PAGE_BYTES];
+        off_t size;
+
+        storage_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (storage_fd < 0) {
+            perror(path);
+            return -1;
+        }
+
+        memset(erased, 0xFF, sizeof(erased));
+        size = lseek(storage_fd, 0, SEEK_END);
+        while (size >= 0 && size < STORAGE_BYTES) {
+            ssize_t n = STORAGE_PAGE_BYTES - size % STORAGE_PAGE_BYTES;
+            if (pwrite(storage_fd, erased, n, size) != n) {
+                perror(path);
+                storage_file_close();
+                return -1;
+            }
+            size += n;
+        }
+        return 0;
+    }
+
+    void storage_file_close() {
+        if (storage_fd >= 0) {
+            close(storage_fd);
+            storage_fd = -1;
+        }
+        return;
+    }
+
+    bool storage_init() {
+        return storage_fd >= 0;
+    }
+
+    bool storage_read(u32 offset, void *dest, u32 size) {
+        if (storage_fd < 0 || offset + size > STORAGE_BYTES) {
+            return false;
+        }
+        return pread(storage_fd, dest, size, offset) == (ssize_t) size;
+    }
+
+    // Program only clears bits, as the flash does
+    bool storage_program(u32 offset, const void *source, u32 size) {
+        unsigned char page[STORAGE_PAGE_BYTES];
+        const unsigned char *bytes = (const unsigned char *) source;
+
+        if (storage_fd < 0 || offset + size > STORAGE_BYTES || offset / STORAGE_PAGE_BYTES != (offset + size - 1) / STORAGE_PAGE_BYTES) {
+            return false;
+        }
+        if (pread(storage_fd, page, size, offset) != (ssize_t) size) {
+            return false;
+        }
+        for (u32 i=0; i<size; ++i) {
+            page[i] &= bytes[i];
+        }
+        return pwrite(storage_fd, page, size, offset) == (ssize_t) size;
+    }
+
+    bool storage_erase(u32 offset) {
+        unsigned char erased[STORAGE_PAGE_BYTES];
+
+        if (storage_fd < 0 || offset >= STORAGE_BYTES) {
+            return false;
+        }
+        memset(erased, 0xFF, sizeof(erased));
+        offset -= offset % STORAGE_SECTOR_BYTES;
+        for (u32 at=0; at<STORAGE_SECTOR_BYTES; at+=STORAGE_PAGE_BYTES) {
+            if (pwrite(storage_fd, erased, STORAGE_PAGE_BYTES, offset + at) != STORAGE_PAGE_BYTES) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool storage_busy() {
+        return false;
+    }
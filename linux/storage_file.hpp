@@ -0,0 +1,18 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: The storage area of c/storage.hpp as a file, in place of the
+// QSPI flash. A new file reads as erased flash. Writes keep the NOR rules so
+// the firmware behaves as it does on target, and finish at once.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_STORAGE_FILE_HPP
+#define MYLIB_STORAGE_FILE_HPP
+
+    // Must come before host_init, without it the storage reports no device
+    int storage_file_open(const char *path);
+    void storage_file_close();
+
+#endif
@@ -0,0 +1,538 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: The host loop against fake windows. Midi goes in through a
+// pipe, the synth registers are checked through a second mapping of the fake
+// window's memory, the way the fabric would see them. The uart window is left
+// closed, its data register pops on read which memory cannot do.
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "xparameters.h"
+#include "constants.hpp"
+#include "tuning.hpp"
+#include "telemetry.hpp"
+#include "recorder.hpp"
+#include "midi_clock.hpp"
+#include "arpeggiator.hpp"
+#include "functions.hpp"
+#include "last_state.hpp"
+#include "zones.hpp"
+#include "sysex.hpp"
+#include "looper.hpp"
+#include "host_loop.hpp"
+#include "storage_file.hpp"
+
+static int failures = 0;
+
+    static void check(bool ok, const char *what) {
+        printf("%s  %s\n", ok ? "pass" : "FAIL", what);
+        if (!ok) {
+            failures = failures+1;
+        }
+        return;
+    }
+
+    // Word index of a bank 0 address in the fabric view
+    static unsigned int word(unsigned int addr) {
+        return (addr - XPAR_FM_SYNTH_WRAPPER_0_BASEADDR)/4;
+    }
+
+    static void send(int fd, unsigned char status, unsigned char data_1, unsigned char data_2) {
+        unsigned char msg[3] = {status, data_1, data_2};
+        if (write(fd, msg, sizeof(msg)) != sizeof(msg)) {
+            perror("pipe");
+        }
+        return;
+    }
+
+    static void send_bytes(int fd, const unsigned char *bytes, unsigned int count) {
+        if (write(fd, bytes, count) != (ssize_t) count) {
+            perror("pipe");
+        }
+        return;
+    }
+
+    // One sysex data chunk, packed 7 bytes into 8. A bad chunk
+    // has its checksum off by one
+    static void send_chunk(int fd, unsigned char target, unsigned int number, const unsigned char *data, unsigned int count, bool good) {
+        unsigned char msg[8 + SYSEX_CHUNK_BYTES + SYSEX_CHUNK_BYTES/7 + 2];
+        unsigned int n = 0;
+        unsigned char sum = 0;
+
+        msg[n++] = SYSEX_START;
+        msg[n++] = SYSEX_ID;
+        msg[n++] = SYSEX_DATA;
+        msg[n++] = target;
+        msg[n++] = number & 0x7F;
+        msg[n++] = (number >> 7) & 0x7F;
+        for (unsigned int i=0; i<count; i+=7) {
+            unsigned char msbs = 0;
+            for (unsigned int j=0; j<7 && i+j<count; ++j) {
+                msbs |= (data[i+j] >> 7) << j;
+            }
+            msg[n++] = msbs;
+            sum += msbs;
+            for (unsigned int j=0; j<7 && i+j<count; ++j) {
+                msg[n++] = data[i+j] & 0x7F;
+                sum += data[i+j] & 0x7F;
+            }
+        }
+        msg[n++] = (128 - (sum & 0x7F) + (good ? 0 : 1)) & 0x7F;
+        msg[n++] = SYSEX_END;
+        send_bytes(fd, msg, n);
+        return;
+    }
+
+    // Keep servicing for ms milliseconds
+    static void run_for(int ms) {
+        XTime start;
+        XTime now;
+
+        XTime_GetTime(&start);
+        do {
+            host_service(1);
+            XTime_GetTime(&now);
+        } while (now - start < (XTime) ms * (COUNTS_PER_SECOND / 1000));
+        return;
+    }
+
+    // Sysex messages waiting on the midi output, every data byte is below 0x80
+    static unsigned int sent_messages(int fd) {
+        unsigned char bytes[4096];
+        unsigned int count = 0;
+        ssize_t n;
+
+        while ((n = read(fd, bytes, sizeof(bytes))) > 0) {
+            for (ssize_t i=0; i<n; ++i) {
+                if (bytes[i] == SYSEX_END) {
+                    count = count+1;
+                }
+            }
+        }
+        return count;
+    }
+
+    // Bytes waiting on the midi output, up to max
+    static unsigned int sent_bytes(int fd, unsigned char *bytes, unsigned int max) {
+        unsigned int count = 0;
+        ssize_t n;
+
+        while (count < max && (n = read(fd, bytes+count, max-count)) > 0) {
+            count = count+(unsigned int) n;
+        }
+        return count;
+    }
+
+    // Records of one type in the flight recorder, the ring has not wrapped
+    static unsigned int recorded(u32 type) {
+        recorder_region *region = (recorder_region *) recorder.data();
+        unsigned int count = 0;
+
+        for (unsigned int n=0; n<region->head; ++n) {
+            if ((region->ring[n].tag & 0xFF) == type) {
+                count = count+1;
+            }
+        }
+        return count;
+    }
+
+    // Channel whose carrier register holds a sounding note, -1 if none
+    static int sounding(volatile u32 *fabric) {
+        for (int chan=0; chan<NUM_CHANNELS; ++chan) {
+            if (fabric[word(CAR_ADDR(0, chan))] & MASK_ON) {
+                return chan;
+            }
+        }
+        return -1;
+    }
+
+    // Channel sounding the carrier word, -1 if none
+    static int playing_on(volatile u32 *fabric, unsigned int carrier) {
+        for (int chan=0; chan<NUM_CHANNELS; ++chan) {
+            if (fabric[word(CAR_ADDR(0, chan))] == (carrier | MASK_ON)) {
+                return chan;
+            }
+        }
+        return -1;
+    }
+
+    // Whether a sounding channel holds the carrier word
+    static bool playing(volatile u32 *fabric, unsigned int carrier) {
+        return playing_on(fabric, carrier) >= 0;
+    }
+
+int main(void) {
+    int midi[2];
+    int out[2];
+    char state_file[] = "/tmp/fm_synth_stateXXXXXX";
+
+    if (uio_open_fake(uio_synth, "fm_synth", XPAR_FM_SYNTH_WRAPPER_0_BASEADDR, 0x1000) < 0 || pipe(midi) < 0 || pipe2(out, O_NONBLOCK) < 0) {
+        return 1;
+    }
+    int state_fd = mkstemp(state_file);
+    if (state_fd < 0 || storage_file_open(state_file) < 0) {
+        return 1;
+    }
+    close(state_fd);
+
+    volatile u32 *fabric = (volatile u32 *) mmap(NULL, 0x1000, PROT_READ, MAP_SHARED, uio_synth.mem_fd, 0);
+    if (fabric == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    host_init(midi[0], out[1]);
+    check(fabric[word(CTRL_REG_ADDR)] == CTRL_INIT, "synth_init writes the control register");
+    check(fabric[word(RC_ATTACK_ADDR)] == RC_ATTACK_INIT, "synth_init writes the attack time");
+    check(fabric[word(VEL_ADDR(0, NUM_CHANNELS-1))] == VELOCITY_INIT, "synth_init writes the velocities");
+    check(last_state.get_sequence() == 0, "an empty store boots on the defaults");
+
+    check(host_service(0) == 0, "an idle poll times out");
+
+    send(midi[1], NOTE_ON, 60, 100);
+    check(host_service(100) == 1, "a note on wakes the loop");
+
+    int chan = sounding(fabric);
+    check(chan >= 0, "note on sets a carrier enable");
+    if (chan < 0) {
+        chan = 0;
+    }
+    check(fabric[word(VEL_ADDR(0, chan))] != 0, "note on writes the velocity");
+    check(uio_latency.count == 1, "the wake up to write latency is recorded");
+
+    send(midi[1], NOTE_OFF, 60, 0);
+    host_service(100);
+    check(!(fabric[word(CAR_ADDR(0, chan))] & MASK_ON), "note off clears the enable");
+    check(fabric[word(CAR_ADDR(0, chan))] != 0, "the tuning word stays through the release");
+
+    uio_fake_interrupt(uio_synth);
+    check(host_service(100) == 1, "the release interrupt wakes the loop");
+    check(fabric[word(CAR_ADDR(0, chan))] == 0, "the interrupt frees the carrier");
+    check(fabric[word(VEL_ADDR(0, chan))] == 0, "the interrupt frees the velocity");
+
+    send(midi[1], NOTE_ON, 62, 100);
+    host_service(100);
+    chan = sounding(fabric);
+    unsigned int even = (chan >= 0) ? fabric[word(CAR_ADDR(0, chan))] : 0;
+    tuning_offsets offsets = {};
+    for (int i=0; i<NUM_TUNING_WORDS; ++i) {
+        offsets.cents[i] = cents_fmt::from_int(50).bits();
+    }
+    tuning_build_offsets(offsets);
+    check(chan >= 0 && fabric[word(CAR_ADDR(0, chan))] == even, "building a tuning leaves the notes alone");
+    tuning_swap();
+    check(chan >= 0 && fabric[word(CAR_ADDR(0, chan))] > even, "the swap retunes the sounding note");
+    check(chan >= 0 && (fabric[word(CAR_ADDR(0, chan))] & MASK_ON), "the retuned note keeps sounding");
+
+    check(telemetry.count.irq_count[TELEMETRY_IRQ_SYNTH] == 1, "telemetry counts the release interrupt");
+    check(telemetry.count.axi_writes > 0, "telemetry counts the register writes");
+    telemetry_frame frame = telemetry.snapshot();
+    check(frame.voices_active == 1 && frame.voices_releasing == 0, "the snapshot counts the sounding voices");
+    check(frame.boot_first_note_us > frame.boot_ready_us, "telemetry reports the boot to first note time");
+
+    check(recorded(RECORDER_WRITE) == telemetry.count.axi_writes, "the recorder logs every register write");
+    check(recorded(RECORDER_MIDI) == 9, "the recorder logs every midi byte");
+    check(recorded(RECORDER_NOTE_ON) == 2 && recorded(RECORDER_FREE) == 1, "the recorder logs the voice allocation");
+
+    unsigned char split[] = {NOTE_ON, MIDI_CLOCK, 64, 100};
+    send_bytes(midi[1], split, sizeof(split));
+    host_service(100);
+    frame = telemetry.snapshot();
+    check(frame.voices_active == 2 && telemetry.count.parser_errors == 0, "a clock inside a note on leaves the parser alone");
+
+    unsigned char arp_on[] = {CONTROL_CHANGE, ARPEGGIATOR, ARP_UP, CONTROL_CHANGE, ARP_RATE, 1, NOTE_ON, 67, 100, MIDI_START};
+    send_bytes(midi[1], arp_on, sizeof(arp_on));
+    host_service(100);
+    frame = telemetry.snapshot();
+    check(frame.voices_active == 2, "with the arpeggiator on a note on is only held");
+
+    unsigned char clock = MIDI_CLOCK;
+    for (int n=0; n<12; ++n) {
+        send_bytes(midi[1], &clock, 1);
+        run_for(20);
+    }
+    check(telemetry.count.arp_steps >= 8, "the arpeggiator steps on the clock");
+    check(tempo.tempo_mbpm() > 110000 && tempo.tempo_mbpm() < 140000, "the tracker follows a 125 bpm clock");
+
+    run_for(20);
+    send_bytes(midi[1], &clock, 1);
+    run_for(20);
+    check(tempo.tempo_mbpm() > 110000 && tempo.tempo_mbpm() < 140000, "a lost clock relocks on the same tempo");
+
+    unsigned char arp_off[] = {MIDI_STOP, CONTROL_CHANGE, ARPEGGIATOR, ARP_OFF};
+    send_bytes(midi[1], arp_off, sizeof(arp_off));
+    host_service(100);
+    frame = telemetry.snapshot();
+    check(frame.voices_active == 2 && !arp.enabled(), "switching the arpeggiator off ends its note");
+
+    // Split at middle C with the upper zone an octave up, a layer on the
+    // upper keys for midi channel 2 only and an octave down layer on hard
+    // notes below the split
+    zone *defined = zones.definitions();
+    defined[0] = {0, 59, 1, 127, ZONE_OMNI, 0, ZONE_PATCH_LIVE, 127};
+    defined[1] = {60, 127, 1, 127, ZONE_OMNI, 12, ZONE_PATCH_LIVE, 127};
+    defined[2] = {60, 127, 1, 127, 1, 0, ZONE_PATCH_LIVE, 127};
+    defined[3] = {0, 59, 100, 127, ZONE_OMNI, -12, ZONE_PATCH_LIVE, 127};
+    zones.request();
+    host_service(0);
+
+    send(midi[1], NOTE_ON, 48, 80);
+    host_service(100);
+    frame = telemetry.snapshot();
+    check(frame.voices_active == 3 && playing(fabric, tuning_word[48-12]), "a split plays the lower zone below the split");
+
+    send(midi[1], NOTE_ON, 72, 80);
+    host_service(100);
+    frame = telemetry.snapshot();
+    check(frame.voices_active == 4 && playing(fabric, tuning_word[72]), "the upper zone plays transposed");
+
+    send(midi[1], NOTE_ON | 1, 74, 80);
+    host_service(100);
+    frame = telemetry.snapshot();
+    check(frame.voices_active == 6 && playing(fabric, tuning_word[74]) && playing(fabric, tuning_word[62]), "a layer on its channel adds a voice to the note");
+
+    send(midi[1], NOTE_ON, 50, 110);
+    host_service(100);
+    frame = telemetry.snapshot();
+    check(frame.voices_active == 8 && playing(fabric, tuning_word[26]), "a hard note plays the velocity layer");
+
+    unsigned int releasing = frame.voices_releasing;
+    send(midi[1], NOTE_OFF | 1, 74, 0);
+    host_service(100);
+    frame = telemetry.snapshot();
+    check(frame.voices_active == 6 && frame.voices_releasing == releasing+2, "a note off releases every layer of the note");
+
+    unsigned char zones_off[] = {NOTE_OFF, 48, 0, 72, 0, 50, 0};
+    send_bytes(midi[1], zones_off, sizeof(zones_off));
+    host_service(100);
+    defined[0] = zone();
+    for (int z=1; z<ZONES_MAX; ++z) {
+        defined[z].channel = ZONE_OFF;
+    }
+    zones.request();
+    host_service(0);
+
+    synth_state preset = presets[0];
+    preset.patch = preset.patch ^ 0x01;
+    send_chunk(midi[1], SYSEX_TARGET_PRESETS, 0, (const unsigned char *) &preset, sizeof(preset), false);
+    host_service(100);
+    check(presets[0].patch != preset.patch, "a bad preset chunk leaves the presets alone");
+    send_chunk(midi[1], SYSEX_TARGET_PRESETS, 0, (const unsigned char *) &preset, sizeof(preset), true);
+    host_service(100);
+    check(presets[0].patch == preset.patch, "a good preset chunk is loaded");
+    presets[0].patch = preset.patch ^ 0x01;
+
+    // Cycle another key through more notes than there are group ids,
+    // none of them may take the id of the held note
+    send(midi[1], NOTE_ON, 36, 100);
+    host_service(100);
+    unsigned char cycle[] = {NOTE_ON, 37, 100, NOTE_OFF, 37, 0};
+    for (int n=0; n<300; ++n) {
+        send_bytes(midi[1], cycle, sizeof(cycle));
+        host_service(100);
+        uio_fake_interrupt(uio_synth);
+        host_service(100);
+    }
+    check(playing(fabric, tuning_word[36-12]), "a wrapped group id leaves the held note alone");
+    send(midi[1], NOTE_OFF, 36, 0);
+    host_service(100);
+    uio_fake_interrupt(uio_synth);
+    host_service(100);
+
+    send(midi[1], NOTE_ON, 40, 100);
+    host_service(100);
+    unsigned int held = telemetry.snapshot().voices_active;
+    unsigned char broken[] = {SYSEX_START, SYSEX_ID, SYSEX_DATA, NOTE_OFF, 40, 0};
+    send_bytes(midi[1], broken, sizeof(broken));
+    host_service(100);
+    check(telemetry.snapshot().voices_active == held-1, "a note off that cuts a sysex short is played");
+
+    sent_messages(out[0]);
+    unsigned char request[] = {SYSEX_START, SYSEX_ID, SYSEX_DUMP_REQUEST, SYSEX_TARGET_RECORDER, SYSEX_END};
+    send_bytes(midi[1], request, sizeof(request));
+    host_service(100);
+    unsigned int chunks = sent_messages(out[0]);
+    check(chunks == 1, "a recorder dump sends one chunk per loop");
+    for (unsigned int n=0; n<2*recorder.size()/SYSEX_CHUNK_BYTES; ++n) {
+        host_service(0);
+        chunks += sent_messages(out[0]);
+    }
+    check(chunks == (recorder.size() + SYSEX_CHUNK_BYTES-1) / SYSEX_CHUNK_BYTES, "the dump sends the whole recorder");
+
+    // The uart window is closed, as with -u none
+    unsigned char baud[] = {SYSEX_START, SYSEX_ID, SYSEX_SET_BAUD, 1, SYSEX_END};
+    send_bytes(midi[1], baud, sizeof(baud));
+    check(host_service(100) == 1 && sent_messages(out[0]) == 1, "a baud rate change without a uart window is answered");
+
+    // A loop recorded on midi channel 2 and ended from that channel
+    unsigned int idle = telemetry.snapshot().voices_active;
+    unsigned char record[] = {CONTROL_CHANGE, LOOPER, LOOP_RECORD, NOTE_ON | 1, 60, 100};
+    unsigned char play[] = {CONTROL_CHANGE | 1, LOOPER, LOOP_PLAY};
+    unsigned char stop[] = {CONTROL_CHANGE, LOOPER, LOOP_IDLE};
+    send_bytes(midi[1], record, sizeof(record));
+    run_for(10);
+    send_bytes(midi[1], play, sizeof(play));
+    run_for(30);
+    check(telemetry.snapshot().voices_active == idle+1, "the loop plays its note on its channel");
+    send_bytes(midi[1], stop, sizeof(stop));
+    host_service(100);
+    check(telemetry.snapshot().voices_active == idle, "stopping the loop releases its note on its channel");
+
+    // Record a note and its aftertouch, play a live note over the loop,
+    // stop it and export the recording
+    unsigned char take[3*42];
+    unsigned char smf[4096];
+    unsigned int size = 0;
+    unsigned int step_max = 0;
+    unsigned int steps = 0;
+    unsigned int touches = 0;
+    take[0] = CONTROL_CHANGE;
+    take[1] = LOOPER;
+    take[2] = LOOP_RECORD;
+    take[3] = NOTE_ON;
+    take[4] = 84;
+    take[5] = 100;
+    for (int n=2; n<42; ++n) {
+        take[3*n] = POLYPHONIC_AFTERTOUCH;
+        take[3*n+1] = 84;
+        take[3*n+2] = n;
+    }
+    send_bytes(midi[1], take, sizeof(take));
+    run_for(10);
+    play[0] = CONTROL_CHANGE;
+    send_bytes(midi[1], play, sizeof(play));
+    run_for(30);
+    send(midi[1], NOTE_ON, 86, 100);
+    host_service(100);
+    check(telemetry.snapshot().voices_active == idle+2, "a live note plays over the loop");
+    send_bytes(midi[1], stop, sizeof(stop));
+    host_service(100);
+    check(telemetry.snapshot().voices_active == idle+1, "stopping the loop leaves the live note");
+    send(midi[1], NOTE_OFF, 86, 0);
+    host_service(100);
+    uio_fake_interrupt(uio_synth);
+    host_service(100);
+
+    sent_messages(out[0]);
+    send(midi[1], CONTROL_CHANGE, LOOPER, LOOP_EXPORT);
+    host_service(100);
+    while (looper.exporting() && steps < 100) {
+        unsigned int got = sent_bytes(out[0], smf+size, sizeof(smf)-size);
+        step_max = (got > step_max) ? got : step_max;
+        size += got;
+        steps += 1;
+        host_service(0);
+    }
+    size += sent_bytes(out[0], smf+size, sizeof(smf)-size);
+    check(!looper.exporting() && steps > 2 && step_max <= LOOP_EXPORT_BYTES, "the export is sent a step at a time");
+    for (unsigned int i=29; i+2<size; ++i) {
+        if (smf[i] == POLYPHONIC_AFTERTOUCH && smf[i+1] == 84) {
+            touches += 1;
+        }
+    }
+    check(size > 32 && !memcmp(smf, "MThd", 4) && !memcmp(smf+14, "MTrk", 4) && (unsigned int) ((smf[18] << 24) | (smf[19] << 16) | (smf[20] << 8) | smf[21]) == size-22, "the export is a midi file of the track length");
+    check(touches == 40 && smf[size-3] == 0xFF && smf[size-2] == 0x2F && smf[size-1] == 0x00, "the export holds every recorded event and ends the track");
+
+    // A note on each of midi channels 1 and 2, bend and aftertouch on
+    // one must leave the other alone
+    unsigned char two[] = {NOTE_ON, 69, 64, NOTE_ON | 1, 71, 64};
+    send_bytes(midi[1], two, sizeof(two));
+    host_service(100);
+    int first = playing_on(fabric, tuning_word[69-12]);
+    int second = playing_on(fabric, tuning_word[71-12]);
+    unsigned int first_vel = (first >= 0) ? fabric[word(VEL_ADDR(0, first))] : 0;
+    unsigned int second_vel = (second >= 0) ? fabric[word(VEL_ADDR(0, second))] : 0;
+    unsigned int merged = telemetry.snapshot().controls_merged;
+    unsigned char bends[] = {PITCH_BEND | 1, 0, 0x50, PITCH_BEND | 1, 0, 0x60, PITCH_BEND | 1, 0, 0x7F};
+    send_bytes(midi[1], bends, sizeof(bends));
+    host_service(100);
+    check(first >= 0 && playing(fabric, tuning_word[69-12]), "a bend on another channel leaves the note alone");
+    check(second >= 0 && fabric[word(CAR_ADDR(0, second))] > (tuning_word[71-12] | MASK_ON), "a bend raises the note on its channel");
+    check(telemetry.snapshot().controls_merged == merged+2, "bends between two control ticks are merged");
+    unsigned char presses[] = {POLYPHONIC_AFTERTOUCH, 71, 127, POLYPHONIC_AFTERTOUCH | 1, 69, 127};
+    send_bytes(midi[1], presses, sizeof(presses));
+    host_service(100);
+    check(first >= 0 && second >= 0 && fabric[word(VEL_ADDR(0, first))] == first_vel && fabric[word(VEL_ADDR(0, second))] == second_vel, "poly aftertouch is kept to its channel");
+    check(telemetry.snapshot().controls_merged == merged+2, "aftertouch on two channels is not merged");
+    presses[1] = 69;
+    presses[4] = 71;
+    send_bytes(midi[1], presses, sizeof(presses));
+    host_service(100);
+    check(first >= 0 && second >= 0 && fabric[word(VEL_ADDR(0, first))] > first_vel && fabric[word(VEL_ADDR(0, second))] > second_vel, "poly aftertouch raises the note it names");
+    unsigned char both_off[] = {NOTE_OFF, 69, 0, NOTE_OFF | 1, 71, 0, PITCH_BEND | 1, 0, 0x40};
+    send_bytes(midi[1], both_off, sizeof(both_off));
+    host_service(100);
+    uio_fake_interrupt(uio_synth);
+    host_service(100);
+
+    // A tuning table in three chunks, the middle one bad at first. The
+    // answers come back in order and nothing is swapped in until every
+    // chunk has been good
+    unsigned int table[NUM_TUNING_WORDS];
+    unsigned char answers[64];
+    for (int i=0; i<NUM_TUNING_WORDS; ++i) {
+        table[i] = tuning_word[i]+1;
+    }
+    const unsigned char *words = (const unsigned char *) table;
+    sent_messages(out[0]);
+    send_chunk(midi[1], SYSEX_TARGET_TUNING, 0, words, SYSEX_CHUNK_BYTES, true);
+    send_chunk(midi[1], SYSEX_TARGET_TUNING, 1, words+SYSEX_CHUNK_BYTES, SYSEX_CHUNK_BYTES, false);
+    send_chunk(midi[1], SYSEX_TARGET_TUNING, 2, words+2*SYSEX_CHUNK_BYTES, sizeof(table)-2*SYSEX_CHUNK_BYTES, true);
+    run_for(20);
+    unsigned int answered = sent_bytes(out[0], answers, sizeof(answers));
+    check(answered == 21 && answers[2] == SYSEX_ACK && answers[9] == SYSEX_NAK && answers[11] == 1 && answers[16] == SYSEX_ACK && answers[18] == 2, "each tuning chunk is answered in order from the main loop");
+    check(tuning_word[0] == table[0]-1 && tuning_word[NUM_TUNING_WORDS-1] == table[NUM_TUNING_WORDS-1]-1, "a tuning with a bad chunk is not swapped in");
+    send_chunk(midi[1], SYSEX_TARGET_TUNING, 1, words+SYSEX_CHUNK_BYTES, SYSEX_CHUNK_BYTES, true);
+    run_for(20);
+    check(sent_messages(out[0]) == 1 && !memcmp(tuning_word, table, sizeof(table)), "the tuning is swapped in once every chunk is good");
+
+    send(midi[1], CONTROL_CHANGE, VOLUME, 20);
+    run_for(LAST_STATE_SETTLE_MS + 3*LAST_STATE_POLL_MS);
+    unsigned int quiet = fabric[word(CTRL_REG_ADDR)];
+    check(last_state.get_sequence() == 1 && quiet != CTRL_INIT, "a settled change is written to storage");
+
+    send(midi[1], CONTROL_CHANGE, VOLUME, 90);
+    run_for(LAST_STATE_SETTLE_MS + 3*LAST_STATE_POLL_MS);
+    unsigned int loud = fabric[word(CTRL_REG_ADDR)];
+    check(last_state.get_sequence() == 2, "the next change gets the next record");
+
+    synth_init(CTRL_INIT);
+    check(fabric[word(CTRL_REG_ADDR)] == loud && last_state.get_sequence() == 2, "a power cycle restores the last state");
+
+    // Clear bits of the check word, as a write cut short would
+    u32 torn = 0;
+    storage_program(LAST_STATE_SLOT_BYTES + offsetof(last_state_record, check), &torn, sizeof(torn));
+    synth_init(CTRL_INIT);
+    check(fabric[word(CTRL_REG_ADDR)] == quiet && last_state.get_sequence() == 1, "a torn record falls back to the one before");
+
+    // Every word the controllers can give, against the shifts
+    // decode_tau and decode_mod_tau used before fixed_point.hpp
+    bool taus = true;
+    bool mod_taus = true;
+    for (unsigned int x=0; x<128; ++x) {
+        decode_tau(x);
+        taus = taus && fabric[word(RC_ATTACK_ADDR)] == x << 3 && fabric[word(RC_DECAY_ADDR)] == x << 1 && fabric[word(RC_RELEASE_ADDR)] == x << 1;
+        decode_mod_tau(x);
+        mod_taus = mod_taus && fabric[word(MOD_TAU_ADDR)] == x << 5;
+    }
+    check(taus, "decode_tau writes the words of the old shifts");
+    check(mod_taus, "decode_mod_tau writes the words of the old shifts");
+
+    close(midi[1]);
+    check(host_service(100) < 0, "closing the midi input ends the loop");
+
+    uio_latency_report(stdout);
+    uio_close(uio_synth);
+    storage_file_close();
+    unlink(state_file);
+
+return failures ? 1 : 0;
+}
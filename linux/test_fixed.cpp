@@ -0,0 +1,298 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Fixed<WI,WF> against a bit for bit model of fixed_point_mult.v
+// and fixed_point_adder.v. The model follows the part selects and
+// concatenations of the hdl on plain words, so any difference in truncation,
+// sign extension, wrap or ovf shows up here. Each format the firmware or the
+// hdl instantiates is run over its edge values and random vectors. The soft
+// voice release is timed against a model of rc_filter_fsm built on the same
+// multiplier.
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include "constants.hpp"
+#include "soft_voice.hpp"
+
+typedef unsigned long long u64;
+
+static int failures = 0;
+
+    static void check(bool ok, const char *what) {
+        printf("%s  %s\n", ok ? "pass" : "FAIL", what);
+        if (!ok) {
+            failures = failures+1;
+        }
+        return;
+    }
+
+    static u64 mask(int n) {
+        return (n <= 0) ? 0 : (n >= 64) ? ~0ULL : (1ULL << n) - 1;
+    }
+
+    // x[hi:lo], empty when hi < lo as for a zero width field
+    static u64 field(u64 x, int hi, int lo) {
+        return (hi < lo) ? 0 : (x >> lo) & mask(hi - lo + 1);
+    }
+
+    static int bit(u64 x, int n) {
+        return (int) ((x >> n) & 1);
+    }
+
+    // Replicate the sign of a from bit word out to a to bit word
+    static u64 sext(u64 x, int from, int to) {
+        return (bit(x, from-1) ? (x | ~mask(from)) : x) & mask(to);
+    }
+
+    static long long as_signed(u64 x, int width) {
+        return (long long) sext(x, width, 64);
+    }
+
+    // fixed_point_mult.v
+    static u64 hdl_mult(u64 in_1, int wi_1, int wf_1, u64 in_2, int wi_2, int wf_2, int wi_o, int wf_o, bool *ovf) {
+        int w = wi_1 + wi_2 + wf_1 + wf_2;
+        int f = wf_1 + wf_2;
+        u64 product = (u64) (as_signed(in_1, wi_1+wf_1) * as_signed(in_2, wi_2+wf_2)) & mask(w);
+        u64 int_out;
+        u64 frac_out = 0;
+
+        *ovf = false;
+        if (wi_o > wi_1 + wi_2) {
+            int_out = sext(field(product, w-1, f), wi_1+wi_2, wi_o);
+        }
+        else if (wi_o == wi_1 + wi_2) {
+            int_out = field(product, w-1, f);
+        }
+        else {
+            int_out = ((u64) bit(product, w-1) << (wi_o-1)) | field(product, wi_o+f-2, f);
+            *ovf = (bit(product, w-1) && field(product, w-1, wi_o+f-1) != mask(w-wi_o-f+1))
+                || (!bit(product, w-1) && field(product, w-1, wi_o+f-1) != 0);
+        }
+
+        if (wf_o > f) {
+            frac_out = field(product, f-1, 0) << (wf_o - f);
+        }
+        else if (wf_o == f) {
+            frac_out = field(product, f-1, 0);
+        }
+        else if (wf_o != 0) {
+            frac_out = field(product, f-1, f-wf_o);
+        }
+        return ((int_out << wf_o) | frac_out) & mask(wi_o + wf_o);
+    }
+
+    // fixed_point_adder.v
+    static u64 hdl_add(u64 in_1, int wi_1, int wf_1, u64 in_2, int wi_2, int wf_2, int wi_o, int wf_o, bool *ovf) {
+        int i_bits = (wi_1 > wi_2) ? wi_1 : wi_2;
+        int f_bits = (wf_1 > wf_2) ? wf_1 : wf_2;
+        u64 int_1 = sext(field(in_1, wi_1+wf_1-1, wf_1), wi_1, i_bits);
+        u64 int_2 = sext(field(in_2, wi_2+wf_2-1, wf_2), wi_2, i_bits);
+        u64 frac_1 = field(in_1, wf_1-1, 0) << (f_bits - wf_1);
+        u64 frac_2 = field(in_2, wf_2-1, 0) << (f_bits - wf_2);
+        u64 input_1 = sext((int_1 << f_bits) | frac_1, i_bits+f_bits, i_bits+f_bits+1);
+        u64 input_2 = sext((int_2 << f_bits) | frac_2, i_bits+f_bits, i_bits+f_bits+1);
+        u64 result = (input_1 + input_2) & mask(i_bits+f_bits+1);
+        u64 i_out = field(result, i_bits+f_bits, f_bits);
+        u64 f_out = field(result, f_bits-1, 0);
+        int sign_1 = bit(in_1, wi_1+wf_1-1);
+        int sign_2 = bit(in_2, wi_2+wf_2-1);
+        u64 int_out;
+        u64 frac_out;
+
+        *ovf = false;
+        if (wi_o > i_bits+1) {
+            int_out = sext(i_out, i_bits+1, wi_o);
+        }
+        else if (wi_o == i_bits+1) {
+            int_out = i_out;
+        }
+        else if (wi_o == i_bits) {
+            int_out = ((u64) bit(i_out, i_bits) << (wi_o-1)) | field(i_out, i_bits-2, 0);
+            *ovf = (sign_1 && sign_2 && !bit(result, i_bits+f_bits-1))
+                || (!sign_1 && !sign_2 && bit(result, i_bits+f_bits-1));
+        }
+        else {
+            *ovf = (bit(i_out, i_bits) && field(i_out, i_bits-1, wi_o-1) != mask(i_bits-wi_o+1))
+                || (!bit(i_out, i_bits) && field(i_out, i_bits-1, wi_o-1) != 0);
+            int_out = ((u64) bit(i_out, i_bits) << (wi_o-1)) | field(i_out, wi_o-2, 0);
+        }
+
+        if (wf_o >= f_bits) {
+            frac_out = f_out << (wf_o - f_bits);
+        }
+        else {
+            frac_out = field(f_out, f_bits-1, f_bits-wf_o);
+        }
+        return ((int_out << wf_o) | frac_out) & mask(wi_o + wf_o);
+    }
+
+    // xorshift64, fixed seed so a failure repeats
+    static u64 random_word() {
+        static u64 x = 0x9E3779B97F4A7C15ULL;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    }
+
+    // Edge values of a width first, then random words. The first 25
+    // vectors of a two input check pair every edge with every edge
+    static u64 vector(int n, int width) {
+        static const u64 edges[] = {0, 1, ~0ULL};
+
+        if (n < 3) {
+            return edges[n] & mask(width);
+        }
+        if (n < 5) {
+            return ((n == 3) ? mask(width-1) : 1ULL << (width-1)) & mask(width);
+        }
+        return random_word() & mask(width);
+    }
+
+    #define VECTORS 100000
+
+    template <int WI_O, int WF_O, int WI_1, int WF_1, int WI_2, int WF_2>
+    static bool mult_agrees() {
+        typedef Fixed<WI_1, WF_1> in_1;
+        typedef Fixed<WI_2, WF_2> in_2;
+        u64 a, b, want;
+        bool ovf, want_ovf;
+
+        for (int n=0; n<VECTORS; ++n) {
+            a = vector((n < 25) ? n % 5 : n, WI_1+WF_1);
+            b = vector((n < 25) ? n / 5 : n, WI_2+WF_2);
+            want = hdl_mult(a, WI_1, WF_1, b, WI_2, WF_2, WI_O, WF_O, &want_ovf);
+            if (fixed_mult<WI_O, WF_O>(in_1::from_word(a), in_2::from_word(b), &ovf).word() != want || ovf != want_ovf) {
+                printf("      %d.%d x %d.%d -> %d.%d: %llX x %llX\n", WI_1, WF_1, WI_2, WF_2, WI_O, WF_O, a, b);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <int WI_O, int WF_O, int WI_1, int WF_1, int WI_2, int WF_2>
+    static bool add_agrees() {
+        typedef Fixed<WI_1, WF_1> in_1;
+        typedef Fixed<WI_2, WF_2> in_2;
+        u64 a, b, want;
+        bool ovf, want_ovf;
+
+        for (int n=0; n<VECTORS; ++n) {
+            a = vector((n < 25) ? n % 5 : n, WI_1+WF_1);
+            b = vector((n < 25) ? n / 5 : n, WI_2+WF_2);
+            want = hdl_add(a, WI_1, WF_1, b, WI_2, WF_2, WI_O, WF_O, &want_ovf);
+            if (fixed_add<WI_O, WF_O>(in_1::from_word(a), in_2::from_word(b), &ovf).word() != want || ovf != want_ovf) {
+                printf("      %d.%d + %d.%d -> %d.%d: %llX + %llX\n", WI_1, WF_1, WI_2, WF_2, WI_O, WF_O, a, b);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // A resize is an adder instance with the second input tied to 0
+    template <int WI_O, int WF_O, int WI, int WF>
+    static bool convert_agrees() {
+        typedef Fixed<WI, WF> in;
+        u64 a, want;
+        bool ovf, want_ovf;
+
+        for (int n=0; n<VECTORS; ++n) {
+            a = vector(n, WI+WF);
+            want = hdl_add(a, WI, WF, 0, WI, WF, WI_O, WF_O, &want_ovf);
+            if (in::from_word(a).template convert<WI_O, WF_O>(&ovf).word() != want || ovf != want_ovf) {
+                printf("      %d.%d -> %d.%d: %llX\n", WI, WF, WI_O, WF_O, a);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // rc_filter_fsm, on strobes of a note held for hold strobes at attack_tau
+    // until the channel goes idle after release at release_tau. The tau is
+    // 2.22 and the envelope 2.22, the stage latches tau and step each clock
+    // and the channel is idle once the next envelope is under MIN
+    static unsigned int fabric_release(unsigned int velocity, unsigned int attack_tau, unsigned int release_tau, unsigned int hold) {
+        const u64 MIN = 8;
+        u64 env = 0;
+        u64 step = (u64) (velocity >> 16) << 8;
+        u64 next;
+        unsigned int strobes = 0;
+        bool ovf;
+
+        for (unsigned int n=0; n<hold; ++n) {
+            env = (hdl_mult(attack_tau, 2, 22, (step - env) & mask(24), 2, 22, 2, 22, &ovf) + env) & mask(24);
+        }
+
+        while (true) {
+            next = (hdl_mult(release_tau, 2, 22, (0 - env) & mask(24), 2, 22, 2, 22, &ovf) + env) & mask(24);
+            if (next < MIN) {
+                return strobes;
+            }
+            env = next;
+            strobes = strobes+1;
+        }
+    }
+
+    // soft_engine, samples from note off until the voice is retired
+    static unsigned int soft_release(unsigned int velocity, unsigned int attack_tau, unsigned int release_tau, unsigned int hold) {
+        static soft_engine engine;
+        int out[1];
+        unsigned int samples = 0;
+
+        engine.set_rates(attack_tau, release_tau, MOD_TAU_INIT);
+        engine.note_on(0, TUNING_WORD[48], TUNING_WORD[36], velocity);
+        for (unsigned int n=0; n<hold; ++n) {
+            engine.render(out, 1);
+        }
+        engine.note_off(0);
+        while (engine.busy() != 0) {
+            engine.render(out, 1);
+            samples = samples+1;
+        }
+        return samples;
+    }
+
+    // Release times within 1% and the release rate, not the attack, sets them
+    static bool release_agrees(unsigned int attack_tau, unsigned int release_tau) {
+        unsigned int fabric = fabric_release(VELOCITY_INIT, attack_tau, release_tau, 8192);
+        unsigned int soft = soft_release(VELOCITY_INIT, attack_tau, release_tau, 8192);
+        unsigned int attack = fabric_release(VELOCITY_INIT, attack_tau, attack_tau, 8192);
+        unsigned int diff = (soft > fabric) ? soft - fabric : fabric - soft;
+
+        printf("      attack %04X release %04X: fabric %u soft %u strobes\n", attack_tau, release_tau, fabric, soft);
+        return diff*100 <= fabric && (attack_tau == release_tau || attack != fabric);
+    }
+
+int main(void) {
+    // decode_tau, decode_mod_tau, detune_word and bend_pitch
+    check(mult_agrees<2,22, 1,7, 2,22>(), "fixed_mult matches the rc tau scaling");
+    check(mult_agrees<4,28, 1,7, 4,28>(), "fixed_mult matches the mod tau scaling");
+    check(mult_agrees<32,0, 32,0, 2,30>(), "fixed_mult matches the unison detune");
+    check(mult_agrees<32,0, 32,0, 1,13>(), "fixed_mult matches the pitch bend interval");
+
+    // Instances in the hdl
+    check(mult_agrees<2,30, 2,30, 2,30>(), "fixed_mult matches adsr_envelope.v");
+    check(mult_agrees<4,28, 4,28, 4,28>(), "fixed_mult matches phase_modulate.v");
+    check(mult_agrees<10,14, 8,16, 7,1>(), "fixed_mult matches the fm_synth_top.v volume");
+
+    // bend_pitch and the tuning builds
+    check(add_agrees<32,0, 32,0, 32,0>(), "fixed_add matches the bent tuning word");
+    check(add_agrees<2,30, 2,30, 2,30>(), "fixed_add matches the detune series");
+    check(add_agrees<2,30, 2,30, 3,30>(), "fixed_add matches the detune series with a wide sum");
+    check(add_agrees<8,8, 8,8, 8,8>(), "fixed_add matches the adder defaults");
+    check(add_agrees<4,20, 8,16, 2,24>(), "fixed_add drops integer bits as the hdl");
+
+    // Note on velocity and aftertouch
+    check(convert_agrees<2,14, 2,6>(), "convert matches the velocity level");
+    check(convert_agrees<2,14, 5,13>(), "convert matches the aftertouch level");
+    check(mult_agrees<2,30, 16,16, 2,30>(), "fixed_mult matches the cents to ratio step");
+
+    // Soft voice envelope against rc_filter_fsm
+    check(release_agrees(0x1000, 0x0400), "soft voice releases at the fabric release tau");
+    check(release_agrees(0x0400, 0x1000), "soft voice releases faster than it attacks");
+    check(release_agrees(0x1000, 0x1000), "soft voice release at the attack tau");
+
+    return failures ? 1 : 0;
+}
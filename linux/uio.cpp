@@ -0,0 +1,243 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Opening, mapping and interrupt handling of the UIO windows
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include "uio.hpp"
+
+uio_window uio_synth;
+uio_window uio_uart;
+uio_latency_stats uio_latency;
+
+    // Read one line of a sysfs attribute, trailing newline removed
+    static int read_attr(const char *path, char *buf, size_t len) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return -1;
+        }
+
+        ssize_t n = read(fd, buf, len-1);
+        close(fd);
+        if (n <= 0) {
+            return -1;
+        }
+
+        buf[n] = 0;
+        if (buf[n-1] == '\n') {
+            buf[n-1] = 0;
+        }
+        return 0;
+    }
+
+    // Index of the uio device whose name matches, -1 if none
+    static int find_uio(const char *name) {
+        char path[64];
+        char attr[64];
+
+        for (int n=0; n<64; ++n) {
+            snprintf(path, sizeof(path), "/sys/class/uio/uio%d/name", n);
+            if (read_attr(path, attr, sizeof(attr)) == 0 && !strcmp(attr, name)) {
+                return n;
+            }
+        }
+        return -1;
+    }
+
+    // Open a window by device tree name (fm_synth_wrapper) or by node
+    // (/dev/uio0) and map its first region. base is the physical address
+    // the firmware uses for the window
+    int uio_open(uio_window &w, const char *dev, UINTPTR base) {
+        char path[64];
+        char attr[64];
+        int n;
+
+        if (!strncmp(dev, "/dev/uio", 8)) {
+            n = atoi(dev+8);
+        }
+        else {
+            n = find_uio(dev);
+            if (n < 0) {
+                fprintf(stderr, "uio: no device named %s\n", dev);
+                return -1;
+            }
+        }
+
+        snprintf(path, sizeof(path), "/sys/class/uio/uio%d/maps/map0/size", n);
+        if (read_attr(path, attr, sizeof(attr)) < 0) {
+            fprintf(stderr, "uio: %s has no map0\n", dev);
+            return -1;
+        }
+        w.size = strtoul(attr, NULL, 0);
+
+        snprintf(path, sizeof(path), "/dev/uio%d", n);
+        w.fd = open(path, O_RDWR | O_CLOEXEC);
+        if (w.fd < 0) {
+            fprintf(stderr, "uio: %s: %s\n", path, strerror(errno));
+            return -1;
+        }
+
+        // Map n of a uio device is selected by offset n pages
+        void *regs = mmap(NULL, w.size, PROT_READ | PROT_WRITE, MAP_SHARED, w.fd, 0);
+        if (regs == MAP_FAILED) {
+            fprintf(stderr, "uio: mmap %s: %s\n", path, strerror(errno));
+            close(w.fd);
+            w.fd = -1;
+            return -1;
+        }
+
+        w.regs = (volatile u32 *) regs;
+        w.base = base;
+        w.mem_fd = -1;
+        w.counted = false;
+        return 0;
+    }
+
+    // Open a window backed by memory in place of the fabric, the eventfd
+    // stands in for the interrupt
+    int uio_open_fake(uio_window &w, const char *name, UINTPTR base, size_t size) {
+        w.mem_fd = memfd_create(name, MFD_CLOEXEC);
+        if (w.mem_fd < 0 || ftruncate(w.mem_fd, size) < 0) {
+            fprintf(stderr, "uio: fake %s: %s\n", name, strerror(errno));
+            return -1;
+        }
+
+        void *regs = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, w.mem_fd, 0);
+        if (regs == MAP_FAILED) {
+            fprintf(stderr, "uio: fake mmap %s: %s\n", name, strerror(errno));
+            close(w.mem_fd);
+            w.mem_fd = -1;
+            return -1;
+        }
+
+        w.fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (w.fd < 0) {
+            fprintf(stderr, "uio: fake irq %s: %s\n", name, strerror(errno));
+            munmap(regs, size);
+            close(w.mem_fd);
+            w.mem_fd = -1;
+            return -1;
+        }
+
+        w.regs = (volatile u32 *) regs;
+        w.base = base;
+        w.size = size;
+        return 0;
+    }
+
+    void uio_close(uio_window &w) {
+        if (w.regs) {
+            munmap((void *) w.regs, w.size);
+        }
+        if (w.fd >= 0) {
+            close(w.fd);
+        }
+        if (w.mem_fd >= 0) {
+            close(w.mem_fd);
+        }
+        w = uio_window();
+        return;
+    }
+
+    // Unmask the interrupt, uio_pdrv_genirq masks it again on every pulse
+    int uio_enable(uio_window &w) {
+        u32 one = 1;
+
+        if (w.mem_fd >= 0) {
+            return 0;
+        }
+        return write(w.fd, &one, sizeof(one)) == sizeof(one) ? 0 : -1;
+    }
+
+    // Interrupts since the last call, once poll reports the window readable.
+    // The device count is a running total, the first read after opening only
+    // counts as one. Pulses while masked are lost, the synth interrupt is one
+    // pulse per release so make_available catches up on the next one
+    unsigned int uio_take(uio_window &w) {
+        if (w.mem_fd >= 0) {
+            u64 events;
+            if (read(w.fd, &events, sizeof(events)) != sizeof(events)) {
+                return 0;
+            }
+            return (unsigned int) events;
+        }
+
+        u32 count;
+        unsigned int delta;
+        if (read(w.fd, &count, sizeof(count)) != sizeof(count)) {
+            return 0;
+        }
+
+        delta = w.counted ? count - w.irq_count : 1;
+        w.irq_count = count;
+        w.counted = true;
+        uio_enable(w);
+        return delta;
+    }
+
+    int uio_fake_interrupt(uio_window &w) {
+        u64 one = 1;
+        return write(w.fd, &one, sizeof(one)) == sizeof(one) ? 0 : -1;
+    }
+
+    void uio_latency_arm() {
+        clock_gettime(CLOCK_MONOTONIC, &uio_latency.wake);
+        uio_latency.armed = true;
+        return;
+    }
+
+    void uio_latency_stamp() {
+        struct timespec now;
+        unsigned long long ns;
+        int bucket;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uio_latency.armed = false;
+
+        ns = (unsigned long long) (now.tv_sec - uio_latency.wake.tv_sec) * 1000000000ULL
+           + now.tv_nsec - uio_latency.wake.tv_nsec;
+
+        uio_latency.count += 1;
+        uio_latency.total_ns += ns;
+        if (ns < uio_latency.min_ns) {
+            uio_latency.min_ns = ns;
+        }
+        if (ns > uio_latency.max_ns) {
+            uio_latency.max_ns = ns;
+        }
+
+        bucket = 0;
+        while ((ns >> (bucket+9)) && bucket < UIO_LATENCY_BUCKETS-1) {
+            bucket = bucket+1;
+        }
+        uio_latency.buckets[bucket] += 1;
+        return;
+    }
+
+    void uio_latency_report(FILE *out) {
+        if (uio_latency.count == 0) {
+            fprintf(out, "latency: no events\n");
+            return;
+        }
+
+        fprintf(out, "latency, poll return to first write, kernel wake up not measured\n");
+        fprintf(out, "latency: %llu events, min %llu ns, mean %llu ns, max %llu ns\n",
+                uio_latency.count, uio_latency.min_ns,
+                uio_latency.total_ns / uio_latency.count, uio_latency.max_ns);
+
+        for (int b=0; b<UIO_LATENCY_BUCKETS; ++b) {
+            if (uio_latency.buckets[b]) {
+                fprintf(out, "  < %8llu ns : %llu\n", 512ULL << b, uio_latency.buckets[b]);
+            }
+        }
+        return;
+    }
@@ -0,0 +1,99 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: UIO register windows for the Linux build. Each window maps one
+// AXI slave into the process, Xil_Out32/Xil_In32 pick the window by the
+// physical address the firmware passes and touch the mapping directly.
+// Interrupts are waited on by polling the window's descriptor.
+//
+// A fake window is backed by a memfd in place of the device and an eventfd in
+// place of the interrupt, so the firmware code runs unchanged without the
+// fabric. Tests raise interrupts with uio_fake_interrupt.
+//
+// The latency stats time the first register write after a wake up. The clock
+// starts when poll returns, uio and the midi input carry no time stamp of
+// their own, so the stats cover the host loop from wake up to the fabric and
+// leave out the kernel's interrupt to wake up time. The report says so.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MYLIB_UIO_HPP
+#define MYLIB_UIO_HPP
+
+#include <stdio.h>
+#include <time.h>
+#include "xil_types.h"
+
+    #define UIO_LATENCY_BUCKETS 24
+
+    /*
+    One mapped register window
+        -regs       : start of the mapping
+        -base       : physical address the firmware uses for the window
+        -size       : bytes mapped
+        -fd         : uio device, or the eventfd of a fake window
+        -mem_fd     : memfd backing a fake window, -1 for a device
+        -irq_count  : interrupt count at the last uio_take
+        -counted    : irq_count holds a device count
+    */
+    struct uio_window {
+        volatile u32 *regs = NULL;
+        UINTPTR base = 0;
+        size_t size = 0;
+        int fd = -1;
+        int mem_fd = -1;
+        u32 irq_count = 0;
+        bool counted = false;
+    };
+
+    /*
+    Wake up to first write latency, from poll returning
+        -armed      : a wake up is waiting on its first write
+        -wake       : time poll returned
+        -count      : wake ups that led to a write
+        -total_ns   : sum of their latencies
+        -min_ns     : shortest latency
+        -max_ns     : longest latency
+        -buckets    : counts by power of two, bucket n holds latencies
+                      under 512 << n ns that missed bucket n-1
+    */
+    struct uio_latency_stats {
+        bool armed = false;
+        struct timespec wake;
+        unsigned long long count = 0;
+        unsigned long long total_ns = 0;
+        unsigned long long min_ns = ~0ULL;
+        unsigned long long max_ns = 0;
+        unsigned long long buckets[UIO_LATENCY_BUCKETS] = {};
+    };
+
+    extern uio_window uio_synth;
+    extern uio_window uio_uart;
+    extern uio_latency_stats uio_latency;
+
+    // Register of the window holding addr, NULL if no open window holds
+    // it. Run with -u none the uart has no window, the firmware still
+    // sets its baud rate on a sysex
+    static inline volatile u32 *uio_reg(UINTPTR addr) {
+        if (addr - uio_synth.base < uio_synth.size) {
+            return uio_synth.regs + (addr - uio_synth.base)/4;
+        }
+        if (addr - uio_uart.base < uio_uart.size) {
+            return uio_uart.regs + (addr - uio_uart.base)/4;
+        }
+        return NULL;
+    }
+
+    int uio_open(uio_window &, const char *, UINTPTR);
+    int uio_open_fake(uio_window &, const char *, UINTPTR, size_t);
+    void uio_close(uio_window &);
+    int uio_enable(uio_window &);
+    unsigned int uio_take(uio_window &);
+    int uio_fake_interrupt(uio_window &);
+
+    void uio_latency_arm();
+    void uio_latency_stamp();
+    void uio_latency_report(FILE *);
+
+#endif
@@ -8,6 +8,14 @@ domain create -name {domain} -proc {ps7_cortexa9_0} -os {standalone}
 
 domain active {domain}
 
+# Second core renders the software voices, USE_AMP leaves the shared
+# caches and SCU to the first core
+domain create -name {domain_cpu1} -proc {ps7_cortexa9_1} -os {standalone}
+
+domain active {domain_cpu1}
+
+bsp config extra_compiler_flags {-mcpu=cortex-a9 -mfpu=vfpv3 -mfloat-abi=hard -nostartfiles -g -Wall -Wextra -DUSE_AMP=1}
+
 platform active {platform}
 
 platform generate
@@ -16,4 +24,32 @@ app create -name {application} -platform {platform} -domain {domain} -template {
 
 importsources -name {application} -path {C:\Users\mfall\Documents\School\year_4\senior_design\synth_git\c} -soft-link
 
-app build -name application
\ No newline at end of file
+app create -name {cpu1} -platform {platform} -domain {domain_cpu1} -template {Empty Application (C++)} -lang {c++}
+
+importsources -name {cpu1} -path {C:\Users\mfall\Documents\School\year_4\senior_design\synth_git\cpu1} -soft-link
+
+app config -name {cpu1} -add include-path {C:\Users\mfall\Documents\School\year_4\senior_design\synth_git\c}
+
+app config -name {cpu1} -add compiler-misc {-mfpu=neon}
+
+app config -name {cpu1} -set compiler-optimization {Optimize most (-O3)}
+
+# Split DDR between the cores, the first core starts the second at 0x10000000.
+# The last 1 MB below it is left out for the flight recorder, see c/recorder.hpp
+proc set_ddr {lscript origin length} {
+    set f [open $lscript r]
+    set text [read $f]
+    close $f
+    regsub {ps7_ddr_0 : ORIGIN = 0x[0-9A-Fa-f]+, LENGTH = 0x[0-9A-Fa-f]+} $text "ps7_ddr_0 : ORIGIN = $origin, LENGTH = $length" text
+    set f [open $lscript w]
+    puts -nonewline $f $text
+    close $f
+}
+
+set_ddr [file join [getws] application src lscript.ld] 0x100000 0xFE00000
+
+set_ddr [file join [getws] cpu1 src lscript.ld] 0x10000000 0x1000000
+
+app build -name application
+
+app build -name cpu1
\ No newline at end of file
@@ -4,6 +4,7 @@ CAR_BASE_ADDR = 0
 MOD_BASE_ADDR = CAR_BASE_ADDR + 4*NUM_CHANNELS
 VEL_BASE_ADDR = MOD_BASE_ADDR + 4*NUM_CHANNELS
 CTRL_REG_ADDR = VEL_BASE_ADDR + 4*NUM_CHANNELS
+ENV_BASE_ADDR = 4*64
 
 CHAN_0_C_ADDR   = CAR_BASE_ADDR + 0
 CHAN_1_C_ADDR   = CAR_BASE_ADDR + 4
@@ -71,6 +72,8 @@ VELOCITY_ADDR= [CHAN_0_V_ADDR,  CHAN_1_V_ADDR,  CHAN_2_V_ADDR,  CHAN_3_V_ADDR,
                 CHAN_8_V_ADDR,  CHAN_9_V_ADDR,  CHAN_10_V_ADDR, CHAN_11_V_ADDR,
                 CHAN_12_V_ADDR, CHAN_13_V_ADDR, CHAN_14_V_ADDR, CHAN_15_V_ADDR]
 
+ENVELOPE_ADDR= [ENV_BASE_ADDR + 4*i for i in range(NUM_CHANNELS)]
+
 
 VELOCITY_INIT = (0b0100_0000_0000_0000_0100_0000_0000_0000)
 CTRL_INIT_SIN = (0b00_0001_0000_001_0000_01111_01111_01111)
@@ -82,6 +85,10 @@ ON_MASK     = (0b1000_0000_0000_0000_0000_0000_0000_0000)
 OFF_MASK    = (0b0111_1111_1111_1111_1111_1111_1111_1111)
 NOTE_OFF    = (0b0000_0000_0000_0000_0000_0000_0000_0000)
 
+ENV_STAGE_IDLE      = 0
+ENV_STAGE_ATTACK    = 1
+ENV_STAGE_RELEASE   = 2
+
 C0          = (0b0000_0000_0000_1100_1001_1010_0010_1100)
 CS0         = (0b0000_0000_0000_1101_0101_1010_0000_0100)
 D0          = (0b0000_0000_0000_1110_0010_0101_0100_0000)
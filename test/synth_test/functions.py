@@ -34,3 +34,13 @@ async def note_off(axi_master, channel):
     carrier = await axi_master.read(CARRIER_ADDR[channel], 4)
     carrier = (int.from_bytes(carrier.data, 'little') & OFF_MASK).to_bytes(4, byteorder = 'little')
     write_op = await axi_master.write(CARRIER_ADDR[channel], carrier)
+
+
+# Envelope word of a channel, the stage and the signed 2.22 level
+async def envelope(axi_master, channel):
+    word = await axi_master.read(ENVELOPE_ADDR[channel], 4)
+    word = int.from_bytes(word.data, 'little')
+    level = word & 0xFFFFFF
+    if level & 0x800000:
+        level = level - 0x1000000
+    return (word >> 24) & 0x3, level
@@ -13,6 +13,10 @@ async def read_write(dut):
     """Simple test for axi slave"""
 
     cocotb.start_soon(Clock(dut.s_axi_aclk, 5, units="ns").start())
+
+    # No software voices streamed in
+    dut.s_axis_mix_tvalid.value = 0
+    dut.s_axis_mix_tdata.value = 0
     
     # Declare axi lite master
     axi_master = AxiLiteMaster(AxiLiteBus.from_prefix(dut, "s_axi"), dut.s_axi_aclk, 
@@ -36,3 +40,51 @@ async def read_write(dut):
 
     dut._log.info('Test done')
 
+
+@cocotb.test()
+async def envelope_readback(dut):
+    """Envelope words follow a note through attack and release"""
+
+    cocotb.start_soon(Clock(dut.s_axi_aclk, 5, units="ns").start())
+
+    # No software voices streamed in
+    dut.s_axis_mix_tvalid.value = 0
+    dut.s_axis_mix_tdata.value = 0
+
+    axi_master = AxiLiteMaster(AxiLiteBus.from_prefix(dut, "s_axi"), dut.s_axi_aclk,
+                                dut.s_axi_aresetn, reset_active_level=False)
+
+    await reset_dut(dut.sys_rst, dut.s_axi_aresetn, 20)
+    await synth_init(axi_master, CTRL_INIT_TRI)
+
+    stage, level = await envelope(axi_master, 0)
+    assert stage == ENV_STAGE_IDLE and level == 0, "channel 0 starts idle"
+
+    await note_on(axi_master, 0, A5, 0, 64)
+    await ClockCycles(dut.word_select, 10)
+
+    stage, level = await envelope(axi_master, 0)
+    assert stage == ENV_STAGE_ATTACK and level > 0, "a held note is in its attack"
+
+    # The other channels never left idle
+    for channel in range(1, NUM_CHANNELS):
+        stage, level = await envelope(axi_master, channel)
+        assert stage == ENV_STAGE_IDLE and level == 0, "channel %d stays idle" % channel
+
+    await note_off(axi_master, 0)
+
+    # Sample the release until the channel goes idle
+    levels = []
+    stage, level = await envelope(axi_master, 0)
+    assert stage == ENV_STAGE_RELEASE, "note off starts the release"
+    while stage == ENV_STAGE_RELEASE:
+        levels.append(level)
+        await ClockCycles(dut.word_select, 1)
+        stage, level = await envelope(axi_master, 0)
+
+    assert len(levels) > 1, "the release lasts more than one frame"
+    assert all(b <= a for a, b in zip(levels, levels[1:])), "the release level never rises"
+    assert levels[-1] < levels[0], "the release level falls"
+    assert stage == ENV_STAGE_IDLE and level == 0, "the channel ends idle"
+
+    dut._log.info('Test done')
@@ -60,3 +60,46 @@ async def read_write(dut):
     await ClockCycles(dut.s_axi_aclk, 1000)
     dut._log.info('Test done')
 
+
+
+@cocotb.test()
+async def high_baud(dut):
+    """Test for runtime selected baud rate and status register"""
+
+    cocotb.start_soon(Clock(dut.s_axi_aclk, 44.286, units="ns").start())
+
+    # Declare uart source at 1 Mbaud
+    uart_source = UartSource(dut.midi_in, baud=1000000, bits=8)
+
+    # Declare axi lite master
+    axi_master = AxiLiteMaster(AxiLiteBus.from_prefix(dut, "s_axi"), dut.s_axi_aclk,
+                                dut.s_axi_aresetn, reset_active_level=False)
+
+    # Reset system
+    await reset_dut(dut.s_axi_aresetn, 20)
+
+    # 22.580647 MHz / 1 Mbaud in 16.8 fixed point
+    await axi_master.write(8, (0x001695).to_bytes(4, 'little'))
+
+    # Send a burst of back to back bytes
+    data = bytes(random.randrange(0,255) for index in range(16))
+    await uart_source.write(data)
+    await uart_source.wait()
+    await ClockCycles(dut.s_axi_aclk, 100)
+
+    # Fifo level and error counters
+    read_data = await axi_master.read(4, 4)
+    assert read_data.data[0] == len(data)
+    assert read_data.data[2] == 0
+    assert read_data.data[3] == 0
+
+    # Drain the fifo until the valid bit clears
+    for num in data:
+        read_data = await axi_master.read(0, 4)
+        assert read_data.data[0] == num
+        assert read_data.data[1] & 0x01
+
+    read_data = await axi_master.read(0, 4)
+    assert read_data.data[1] & 0x01 == 0
+
+    dut._log.info('Test done')
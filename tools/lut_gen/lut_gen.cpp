@@ -0,0 +1,266 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Generates the quarter-wave sine table read by cos_lut.v and
+// reports how closely the full wave rebuilt by quadrant.v matches an ideal
+// sine. Replaces calculate_cos_lut_values.mlx, the defaults reproduce the
+// committed hdl/lut.mem bit for bit.
+//
+//      lut_gen [-d depth] [-w width] [-f frac bits] [-r round|floor|ceil]
+//              [-p zero|half] [-o file] [-q]
+//
+//      -d  : table depth, a power of two (32768)
+//      -w  : word width in bits (18)
+//      -f  : fraction bits, full scale is 2^f (width-2)
+//      -r  : rounding of each entry (round)
+//      -p  : sample phase, zero samples at k/depth and half at (k+0.5)/depth
+//            of the quarter wave. quadrant.v mirrors entry k onto depth-1-k,
+//            which is exact only for half (zero)
+//      -o  : output file, $readmemb format (lut.mem)
+//      -q  : skip the spectrum in the report
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex>
+#include <vector>
+
+    #define ROUND_NEAREST   0
+    #define ROUND_FLOOR     1
+    #define ROUND_CEIL      2
+
+    struct lut_config {
+        unsigned int depth = 32768;
+        unsigned int width = 18;
+        int frac_bits = -1;
+        int rounding = ROUND_NEAREST;
+        bool half_phase = false;
+        const char *file = "lut.mem";
+        bool spectrum = true;
+    };
+
+static bool power_of_two(unsigned int x) {
+    return x != 0 && (x & (x-1)) == 0;
+}
+
+static long long quantize(double x, int rounding) {
+    switch (rounding) {
+        case ROUND_FLOOR : return (long long) floor(x);
+        case ROUND_CEIL  : return (long long) ceil(x);
+        default          : return (long long) floor(x + 0.5);
+    }
+}
+
+// Quarter wave of sine, clamped to the largest positive word
+static std::vector<long long> build_table(const lut_config &cfg) {
+    std::vector<long long> table(cfg.depth);
+    double offset = cfg.half_phase ? 0.5 : 0.0;
+    double scale = ldexp(1.0, cfg.frac_bits);
+    long long max = (1LL << (cfg.width-1)) - 1;
+
+    for (unsigned int k=0; k<cfg.depth; ++k) {
+        table[k] = quantize(sin(M_PI/2 * (k + offset) / cfg.depth) * scale, cfg.rounding);
+        if (table[k] > max) {
+            table[k] = max;
+        }
+    }
+    return table;
+}
+
+// Full wave sample n as quadrant.v rebuilds it from the table
+static long long rebuild(const std::vector<long long> &table, unsigned int n) {
+    unsigned int depth = table.size();
+    unsigned int quad = n / depth;
+    unsigned int addr = n % depth;
+
+    switch (quad) {
+        case 0  : return  table[addr];
+        case 1  : return  table[depth-1-addr];
+        case 2  : return -table[addr];
+        default : return -table[depth-1-addr];
+    }
+}
+
+static bool write_table(const std::vector<long long> &table, const lut_config &cfg) {
+    FILE *out = fopen(cfg.file, "w");
+    unsigned long long word;
+
+    if (out == NULL) {
+        perror(cfg.file);
+        return false;
+    }
+
+    for (unsigned int k=0; k<table.size(); ++k) {
+        word = (unsigned long long) table[k];
+        for (int bit=cfg.width-1; bit>=0; --bit) {
+            fputc((word >> bit) & 1 ? '1' : '0', out);
+        }
+        fputc('\n', out);
+    }
+    fclose(out);
+    return true;
+}
+
+// In place radix 2 transform
+static void fft(std::vector<std::complex<double> > &x) {
+    unsigned int n = x.size();
+
+    for (unsigned int i=1, j=0; i<n; ++i) {
+        unsigned int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(x[i], x[j]);
+        }
+    }
+
+    for (unsigned int len=2; len<=n; len<<=1) {
+        std::complex<double> step = std::polar(1.0, -2*M_PI/len);
+        for (unsigned int i=0; i<n; i+=len) {
+            std::complex<double> w = 1;
+            for (unsigned int k=0; k<len/2; ++k) {
+                std::complex<double> a = x[i+k];
+                std::complex<double> b = x[i+k+len/2] * w;
+                x[i+k] = a + b;
+                x[i+k+len/2] = a - b;
+                w *= step;
+            }
+        }
+    }
+    return;
+}
+
+// Block rams of 36Kb needed for one table, using the best aspect ratio
+static unsigned int bram36_count(unsigned int depth, unsigned int width) {
+    static const unsigned int ASPECT[6][2] = {
+        {32768, 1}, {16384, 2}, {8192, 4}, {4096, 9}, {2048, 18}, {1024, 36}
+    };
+    unsigned int best = 0;
+    unsigned int count;
+
+    for (unsigned int i=0; i<6; ++i) {
+        count = ((depth + ASPECT[i][0] - 1) / ASPECT[i][0]) * ((width + ASPECT[i][1] - 1) / ASPECT[i][1]);
+        if (best == 0 || count < best) {
+            best = count;
+        }
+    }
+    return best;
+}
+
+static void report(const std::vector<long long> &table, const lut_config &cfg) {
+    unsigned int n = 4 * cfg.depth;
+    double scale = ldexp(1.0, cfg.frac_bits);
+    double offset = cfg.half_phase ? 0.5 : 0.0;
+    double quant_max = 0;
+    double wave_max = 0;
+    double wave_sq = 0;
+    double error;
+    std::vector<std::complex<double> > bins;
+
+    // Quantization of the stored entries alone
+    for (unsigned int k=0; k<cfg.depth; ++k) {
+        error = fabs(table[k] - sin(M_PI/2 * (k + offset) / cfg.depth) * scale);
+        quant_max = error > quant_max ? error : quant_max;
+    }
+
+    // Rebuilt full wave against an ideal sine at the phase accumulator points
+    for (unsigned int i=0; i<n; ++i) {
+        error = rebuild(table, i) - sin(2*M_PI * (i + offset) / n) * scale;
+        wave_max = fabs(error) > wave_max ? fabs(error) : wave_max;
+        wave_sq += error * error;
+    }
+
+    printf("table        : %u x %u bits, full scale 2^%d, %s rounding, %s phase\n",
+           cfg.depth, cfg.width, cfg.frac_bits,
+           cfg.rounding == ROUND_FLOOR ? "floor" : cfg.rounding == ROUND_CEIL ? "ceil" : "nearest",
+           cfg.half_phase ? "half" : "zero");
+    printf("block ram    : %u x RAMB36 per table\n", bram36_count(cfg.depth, cfg.width));
+    printf("entry error  : %.3f lsb max\n", quant_max);
+    printf("wave error   : %.3f lsb max, %.3f lsb rms, snr %.2f dB\n",
+           wave_max, sqrt(wave_sq / n), 20*log10((scale / sqrt(2.0)) / sqrt(wave_sq / n + 1e-30)));
+
+    if (!cfg.spectrum) {
+        return;
+    }
+
+    // Largest spur next to the fundamental over one full cycle
+    bins.resize(n);
+    for (unsigned int i=0; i<n; ++i) {
+        bins[i] = (double) rebuild(table, i);
+    }
+    fft(bins);
+
+    double fundamental = std::abs(bins[1]);
+    double spur = 0;
+    for (unsigned int i=2; i<n/2; ++i) {
+        spur = std::abs(bins[i]) > spur ? std::abs(bins[i]) : spur;
+    }
+    printf("sfdr         : %.2f dBc\n", 20*log10(fundamental / (spur + 1e-30)));
+    return;
+}
+
+static void usage() {
+    fprintf(stderr, "usage: lut_gen [-d depth] [-w width] [-f frac bits] [-r round|floor|ceil] "
+                    "[-p zero|half] [-o file] [-q]\n");
+    return;
+}
+
+int main(int argc, char **argv) {
+    lut_config cfg;
+    std::vector<long long> table;
+
+    for (int i=1; i<argc; ++i) {
+        if (!strcmp(argv[i], "-q")) {
+            cfg.spectrum = false;
+            continue;
+        }
+        if (i+1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        if      (!strcmp(argv[i], "-d")) cfg.depth = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-w")) cfg.width = strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-f")) cfg.frac_bits = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-o")) cfg.file = argv[++i];
+        else if (!strcmp(argv[i], "-r")) {
+            ++i;
+            if      (!strcmp(argv[i], "round")) cfg.rounding = ROUND_NEAREST;
+            else if (!strcmp(argv[i], "floor")) cfg.rounding = ROUND_FLOOR;
+            else if (!strcmp(argv[i], "ceil"))  cfg.rounding = ROUND_CEIL;
+            else { usage(); return 1; }
+        }
+        else if (!strcmp(argv[i], "-p")) {
+            ++i;
+            if      (!strcmp(argv[i], "zero")) cfg.half_phase = false;
+            else if (!strcmp(argv[i], "half")) cfg.half_phase = true;
+            else { usage(); return 1; }
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (cfg.frac_bits < 0) {
+        cfg.frac_bits = cfg.width - 2;
+    }
+
+    if (!power_of_two(cfg.depth) || cfg.width < 2 || cfg.width > 32 || cfg.frac_bits > (int) cfg.width - 1) {
+        fprintf(stderr, "lut_gen: depth must be a power of two, width 2 to 32 and frac bits below width\n");
+        return 1;
+    }
+
+    table = build_table(cfg);
+    if (!write_table(table, cfg)) {
+        return 1;
+    }
+    report(table, cfg);
+    return 0;
+}
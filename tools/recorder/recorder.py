@@ -0,0 +1,272 @@
+#!/usr/bin/env python3
+# Author: agent
+# Date : 10/19/26
+# Design Name: FM SYNTHESIZER
+#
+# Description: Rebuilds the timeline held by the firmware flight recorder, see
+# c/recorder.hpp. The region is read from the sysex dump of
+# SYSEX_TARGET_RECORDER on the debug uart, anything else on the line is
+# skipped. Records are put back in order by their record number and the
+# time stamps unwrapped against the timer high words the firmware logs.
+#
+#   recorder.py [-b baud] [--raw file] [--last n] [--run n] source
+#   recorder.py --request
+#
+#   source      : serial port (needs pyserial), capture file or - for stdin
+#   -b          : serial rate (115200)
+#   --raw       : also save the reassembled region
+#   --last      : print only the newest n records
+#   --run       : print only records of run n, 0 for the last run
+#   --request   : print the sysex that asks for the dump, send it to the
+#                 midi input
+
+import argparse
+import struct
+import sys
+
+SYSEX_ID = 0x7D
+SYSEX_DUMP_REQUEST = 0x01
+SYSEX_DATA = 0x02
+SYSEX_TARGET_RECORDER = 0x06
+SYSEX_CHUNK_BYTES = 256
+
+MAGIC = 0x464C5452
+VERSION = 1
+HEADER = struct.Struct('<5I')
+RECORD = struct.Struct('<4I')
+
+COUNTS_PER_SECOND = 666666687 // 2
+
+BOOT = 0x01
+TIME = 0x02
+RESTORE = 0x03
+SAVE = 0x04
+MIDI = 0x10
+WRITE = 0x20
+NOTE_ON = 0x30
+RETRIGGER = 0x31
+NOTE_OFF = 0x32
+STEAL = 0x33
+DROP = 0x34
+SPILL = 0x35
+FREE = 0x36
+ARP = 0x37
+NOT_HELD = 0x100
+
+# enum states of c/midi_parser.hpp
+STATES = ['STATUS', 'NOTE_ON', 'NOTE_OFF', 'CONTROL_CHANGE', 'VELOCITY_ON',
+          'VELOCITY_OFF', 'PATCH', 'VOLUME', 'MOD_TAU', 'RC_TAU',
+          'PITCH_BEND_LSB', 'PITCH_BEND_MSB', 'MODULATE',
+          'POLY_PRESSURE_NOTE', 'POLY_PRESSURE', 'CHANNEL_PRESSURE', 'UNISON',
+          'LOOPER', 'BANKS', 'PROGRAM', 'ARP_MODE', 'ARP_RATE', 'SYSEX',
+          'ERROR']
+
+# Word index within a synth bank, see hdl/const_pckg.sv
+NUM_CHANNELS = 16
+SHARED = {48: 'CTRL', 49: 'RC_ATTACK', 50: 'RC_DECAY', 51: 'RC_RELEASE',
+          52: 'MOD_TAU'}
+BANK_WINDOW = 0x200
+
+
+def unpack_sysex(body):
+    # 7 bytes packed into 8, the first byte of each group holds the msbs
+    data = bytearray()
+    for i in range(0, len(body), 8):
+        msbs = body[i]
+        for j, x in enumerate(body[i+1:i+8]):
+            data.append(x | (((msbs >> j) & 1) << 7))
+    return bytes(data)
+
+
+def read_chunks(source):
+    """Data chunks of the recorder target by chunk number"""
+    chunks = {}
+    buf = bytearray()
+    while True:
+        data = source.read(256) if hasattr(source, 'in_waiting') else source.read1(256)
+        if not data:
+            if hasattr(source, 'in_waiting') and not chunks:
+                continue
+            return chunks
+        buf += data
+        while True:
+            start = buf.find(b'\xf0')
+            if start < 0:
+                buf = bytearray()
+                break
+            end = buf.find(b'\xf7', start)
+            if end < 0:
+                del buf[:start]
+                break
+            message = bytes(buf[start:end+1])
+            del buf[:end+1]
+
+            # F0 7D 02 06 <chunk lsb> <chunk msb> <data ...> <checksum> F7
+            if len(message) < 8 or message[1:4] != bytes([SYSEX_ID, SYSEX_DATA, SYSEX_TARGET_RECORDER]):
+                continue
+            packed = message[6:-1]
+            if sum(packed) & 0x7F:
+                print('chunk %d: bad checksum' % (message[4] | message[5] << 7), file=sys.stderr)
+                continue
+            chunks[message[4] | message[5] << 7] = unpack_sysex(packed[:-1])
+
+
+def open_source(name, baud):
+    if name == '-':
+        return sys.stdin.buffer
+    if name.startswith('/dev/') or name.upper().startswith('COM'):
+        import serial
+        return serial.Serial(name, baud, timeout=2.0)
+    return open(name, 'rb')
+
+
+def request_message():
+    return bytes([0xF0, SYSEX_ID, SYSEX_DUMP_REQUEST, SYSEX_TARGET_RECORDER, 0xF7])
+
+
+def assemble(chunks):
+    region = bytearray()
+    for number in range(max(chunks) + 1):
+        if number not in chunks:
+            raise ValueError('chunk %d is missing' % number)
+        region += chunks[number]
+    return bytes(region)
+
+
+def records(region):
+    """Records oldest first as (number, time, type, a, b)"""
+    magic, version, count, boots, head = HEADER.unpack_from(region)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError('not a recorder region')
+    if len(region) < HEADER.size + count * RECORD.size:
+        raise ValueError('region is short, %d bytes' % len(region))
+
+    # Slots not yet written or overwritten while the dump was sent
+    # carry a record number that does not fit their place
+    out = []
+    for n in range(max(0, head - count), head):
+        time, tag, a, b = RECORD.unpack_from(region, HEADER.size + (n % count) * RECORD.size)
+        if tag >> 8 == n & 0xFFFFFF:
+            out.append((n, time, tag & 0xFF, a, b))
+    return boots, out
+
+
+def unwrap(entries):
+    """Full timer counts, the low words unwrapped against the time records"""
+    high = None
+    last = 0
+    for n, time, kind, a, b in entries:
+        if kind == TIME:
+            high = a
+        elif high is not None and time < last:
+            high += 1
+        last = time
+        yield n, None if high is None else (high << 32) | time, kind, a, b
+
+
+def register(addr):
+    offset = (addr % BANK_WINDOW) // 4
+    bank = addr - addr % BANK_WINDOW
+    if offset < 3 * NUM_CHANNELS:
+        name = '%s[%d]' % (('CAR', 'MOD', 'VEL')[offset // NUM_CHANNELS], offset % NUM_CHANNELS)
+    else:
+        name = SHARED.get(offset, 'REG%d' % offset)
+    return '%08X %s' % (bank, name)
+
+
+def state(x):
+    return STATES[x] if x < len(STATES) else str(x)
+
+
+def key(a):
+    return 'key %d ch %d' % (a & 0xFF, ((a >> 8) & 0xFF) + 1)
+
+
+def describe(kind, a, b):
+    if kind == BOOT:
+        return 'boot      run %d, %d records before it' % (a, b)
+    if kind == TIME:
+        return 'time      %08X%08X' % (a, b)
+    if kind == RESTORE:
+        if a == 0:
+            return 'restore   nothing stored, next slot %d' % b
+        return 'restore   last state %d, next slot %d' % (a, b)
+    if kind == SAVE:
+        return 'save      last state %d to slot %d' % (a, b)
+    if kind == MIDI:
+        return 'midi      %02X  %s -> %s' % (a, state(b & 0xFF), state(b >> 8))
+    if kind == WRITE:
+        return 'write     %-22s %08X' % (register(a), b)
+    if kind == NOTE_ON:
+        return 'note on   %s group %d, %d channels from bank %d chan %d' % (
+            key(a), b & 0xFF, (b >> 8) & 0xFF, (b >> 16) & 0xFF, b >> 24)
+    if kind == RETRIGGER:
+        return 'retrigger %s group %d' % (key(a), b)
+    if kind == NOTE_OFF:
+        if b == 0:
+            return 'note off  %s software voice' % key(a)
+        if b == NOT_HELD:
+            return 'note off  %s not held' % key(a)
+        return 'note off  %s group %d' % (key(a), b)
+    if kind == STEAL:
+        return 'steal     group %d at bank %d chan %d, level %06X%s' % (
+            a & 0xFF, (a >> 8) & 0xFF, a >> 16, b & 0x7FFFFFFF,
+            ' held' if b >> 31 else '')
+    if kind == DROP:
+        return 'drop      %08X' % a
+    if kind == SPILL:
+        return 'spill     %08X to a software voice' % a
+    if kind == FREE:
+        return 'free      bank %d chan %d' % (a, b)
+    if kind == ARP:
+        return 'arp       note %d, %.1f us late' % (a, b * 1e6 / COUNTS_PER_SECOND)
+    return 'type %02X   %08X %08X' % (kind, a, b)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode the synth flight recorder')
+    parser.add_argument('source', nargs='?')
+    parser.add_argument('-b', '--baud', type=int, default=115200)
+    parser.add_argument('--raw')
+    parser.add_argument('--last', type=int)
+    parser.add_argument('--run', type=int)
+    parser.add_argument('--request', action='store_true')
+    args = parser.parse_args()
+
+    if args.request:
+        print(request_message().hex(' '))
+        return 0
+    if args.source is None:
+        parser.error('a source is needed')
+
+    chunks = read_chunks(open_source(args.source, args.baud))
+    if not chunks:
+        print('no recorder dump found', file=sys.stderr)
+        return 1
+    region = assemble(chunks)
+    if args.raw:
+        with open(args.raw, 'wb') as f:
+            f.write(region)
+
+    boots, entries = records(region)
+    run = boots - len([e for e in entries if e[2] == BOOT])
+    timeline = []
+    for n, time, kind, a, b in unwrap(entries):
+        if kind == BOOT:
+            run = a
+        timeline.append((run, n, time, kind, a, b))
+
+    if args.run is not None:
+        keep = boots if args.run == 0 else args.run
+        timeline = [x for x in timeline if x[0] == keep]
+    if args.last is not None:
+        timeline = timeline[-args.last:]
+
+    for run, n, time, kind, a, b in timeline:
+        stamp = '%14.6f' % (time / COUNTS_PER_SECOND) if time is not None else '%14s' % '?'
+        print('%3d %8d %s  %s' % (run, n, stamp, describe(kind, a, b)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,206 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Author: agent
+// Date : 10/19/26
+// Design Name: FM SYNTHESIZER
+//
+// Description: Converts a Scala .scl scale for the firmware tuning tables,
+// either as the sysex messages of SYSEX_TARGET_SCALE or as a header for
+// TUNING_SCALE_HEADER. The scale repeats from the root note with the last
+// pitch of the file as its period, see tuning.hpp.
+//
+//      scl_conv [-r root] [-o file] [-H] scale.scl
+//
+//      -r  : midi note the scale starts on, it keeps its 12 TET pitch (60)
+//      -o  : output file (stdout)
+//      -H  : write a header declaring BUILD_SCALE instead of sysex
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <vector>
+
+// Must match c/tuning.hpp and c/sysex.hpp
+#define NUM_TUNING_WORDS        144
+#define TUNING_MAX_DEGREES      128
+#define SYSEX_ID                0x7D
+#define SYSEX_DATA              0x02
+#define SYSEX_TARGET_SCALE      0x03
+#define SYSEX_CHUNK_BYTES       256
+
+    // Next line that is not a comment, NULL at the end of the file
+    static char *next_line(FILE *in, char *line, int len) {
+        while (fgets(line, len, in) != NULL) {
+            if (line[0] != '!') {
+                line[strcspn(line, "\r\n")] = 0;
+                return line;
+            }
+        }
+        return NULL;
+    }
+
+    // One pitch line, cents if it has a point and a ratio or integer otherwise
+    static bool parse_pitch(const char *line, double *cents) {
+        char *end;
+        double num, den = 1.0;
+
+        while (*line == ' ' || *line == '\t') {
+            line = line+1;
+        }
+
+        if (strchr(line, '.') != NULL) {
+            *cents = strtod(line, &end);
+            return end != line;
+        }
+
+        num = strtod(line, &end);
+        if (end == line) {
+            return false;
+        }
+        if (*end == '/') {
+            den = strtod(end+1, &end);
+        }
+        if (num <= 0 || den <= 0) {
+            return false;
+        }
+        *cents = 1200.0 * log2(num / den);
+        return true;
+    }
+
+    static void put_word(std::vector<unsigned char> &bytes, unsigned int x) {
+        for (int i=0; i<4; ++i) {
+            bytes.push_back((x >> (8*i)) & 0xFF);
+        }
+        return;
+    }
+
+    // SYSEX_DATA messages for the bytes of a tuning_scale
+    static void write_sysex(FILE *out, const std::vector<unsigned char> &bytes) {
+        for (unsigned int base=0, number=0; base<bytes.size(); base+=SYSEX_CHUNK_BYTES, ++number) {
+            unsigned int length = (bytes.size() - base > SYSEX_CHUNK_BYTES) ? SYSEX_CHUNK_BYTES : bytes.size() - base;
+            unsigned char check = 0;
+
+            fputc(0xF0, out);
+            fputc(SYSEX_ID, out);
+            fputc(SYSEX_DATA, out);
+            fputc(SYSEX_TARGET_SCALE, out);
+            fputc(number & 0x7F, out);
+            fputc((number >> 7) & 0x7F, out);
+
+            for (unsigned int i=0; i<length; i+=7) {
+                unsigned char packed = 0;
+                for (unsigned int j=0; j<7 && i+j<length; ++j) {
+                    packed |= (bytes[base+i+j] >> 7) << j;
+                }
+                fputc(packed, out);
+                check += packed;
+
+                for (unsigned int j=0; j<7 && i+j<length; ++j) {
+                    fputc(bytes[base+i+j] & 0x7F, out);
+                    check += bytes[base+i+j] & 0x7F;
+                }
+            }
+
+            fputc((128 - (check & 0x7F)) & 0x7F, out);
+            fputc(0xF7, out);
+        }
+        return;
+    }
+
+int main(int argc, char **argv) {
+    int root_note = 60;
+    const char *out_name = NULL;
+    bool header = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:o:H")) != -1) {
+        switch (opt) {
+            case 'r' : root_note = atoi(optarg);    break;
+            case 'o' : out_name = optarg;           break;
+            case 'H' : header = true;               break;
+            default  :
+                fprintf(stderr, "usage: %s [-r root] [-o file] [-H] scale.scl\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind != argc-1) {
+        fprintf(stderr, "usage: %s [-r root] [-o file] [-H] scale.scl\n", argv[0]);
+        return 1;
+    }
+
+    // Table entry n is midi note n+12
+    int root = root_note - 12;
+    if (root < 0 || root >= NUM_TUNING_WORDS) {
+        fprintf(stderr, "root note must be 12 to %d\n", NUM_TUNING_WORDS+11);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[optind], "r");
+    if (in == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    char line[256];
+    char description[256];
+    char *text = next_line(in, line, sizeof(line));
+    if (text == NULL) {
+        fprintf(stderr, "%s: no description line\n", argv[optind]);
+        return 1;
+    }
+    strcpy(description, text);
+
+    text = next_line(in, line, sizeof(line));
+    int degrees = text ? atoi(text) : 0;
+    if (degrees < 1 || degrees > TUNING_MAX_DEGREES) {
+        fprintf(stderr, "%s: scale needs 1 to %d notes\n", argv[optind], TUNING_MAX_DEGREES);
+        return 1;
+    }
+
+    // 16.16 cents, as cents_fmt
+    std::vector<int> cents;
+    for (int d=0; d<degrees; ++d) {
+        double x;
+        text = next_line(in, line, sizeof(line));
+        if (text == NULL || !parse_pitch(text, &x)) {
+            fprintf(stderr, "%s: bad pitch %d\n", argv[optind], d+1);
+            return 1;
+        }
+        cents.push_back((int) lround(x * 65536.0));
+    }
+    fclose(in);
+
+    FILE *out = out_name ? fopen(out_name, header ? "w" : "wb") : stdout;
+    if (out == NULL) {
+        perror(out_name);
+        return 1;
+    }
+
+    if (header) {
+        fprintf(out, "// %s, generated by scl_conv from %s\n", description, argv[optind]);
+        fprintf(out, "static const tuning_scale BUILD_SCALE = {%d, %d, {", root, degrees);
+        for (int d=0; d<degrees; ++d) {
+            fprintf(out, "%s%s%d", d ? "," : "", (d % 8) ? " " : "\n    ", cents[d]);
+        }
+        fprintf(out, "\n}};\n");
+    }
+
+    else {
+        std::vector<unsigned char> bytes;
+        put_word(bytes, root);
+        put_word(bytes, degrees);
+        for (int d=0; d<TUNING_MAX_DEGREES; ++d) {
+            put_word(bytes, d < degrees ? (unsigned int) cents[d] : 0);
+        }
+        write_sysex(out, bytes);
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+
+return 0;
+}
@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+# Author: agent
+# Date : 10/19/26
+# Design Name: FM SYNTHESIZER
+#
+# Description: Decodes the firmware telemetry from the debug uart, see
+# c/telemetry.hpp. Both the binary stream frames and sysex dumps of
+# SYSEX_TARGET_TELEMETRY are read, anything else on the line (prints, other
+# sysex replies) is skipped.
+#
+#   telemetry.py [-b baud] [--csv file] [--plot] source
+#   telemetry.py --period n
+#
+#   source      : serial port (needs pyserial), capture file or - for stdin
+#   -b          : serial rate (115200)
+#   --csv       : also write every frame to a csv file
+#   --plot      : plot voices, handler load, bus writes and fifo peak live
+#                 (needs matplotlib)
+#   --period    : print the sysex that sets the stream period to n * 100 ms,
+#                 send it to the midi input. 0 stops the stream
+
+import argparse
+import struct
+import sys
+
+SYNC = b'\xa5\x5a'
+VERSION = 4
+
+SYSEX_ID = 0x7D
+SYSEX_DATA = 0x02
+SYSEX_SET_TELEMETRY = 0x04
+SYSEX_TARGET_TELEMETRY = 0x05
+
+# telemetry_frame, every field a little endian 32 bit word
+FIELDS = ['sequence', 'uptime_ms', 'irq_synth', 'irq_uart', 'irq_wave_sel',
+          'irq_timer', 'parser_errors', 'notes_dropped', 'notes_stolen',
+          'voices_active', 'voices_releasing', 'uart_fifo_irq_peak',
+          'uart_overruns', 'axi_writes', 'axi_writes_per_sec', 'isr_load',
+          'tempo_mbpm', 'arp_steps', 'arp_jitter_max_ns', 'arp_jitter_mean_ns',
+          'boot_ready_us', 'boot_first_note_us', 'last_state',
+          'controls_merged']
+FRAME_BYTES = 4 * len(FIELDS)
+
+
+def fletcher16(data):
+    sum_1 = 0
+    sum_2 = 0
+    for x in data:
+        sum_1 = (sum_1 + x) % 255
+        sum_2 = (sum_2 + sum_1) % 255
+    return sum_1, sum_2
+
+
+def unpack_frame(data):
+    frame = dict(zip(FIELDS, struct.unpack('<%dI' % len(FIELDS), data)))
+    frame['isr_load'] = frame['isr_load'] / 65536.0
+    return frame
+
+
+def unpack_sysex(body):
+    # 7 bytes packed into 8, the first byte of each group holds the msbs
+    data = bytearray()
+    for i in range(0, len(body), 8):
+        msbs = body[i]
+        for j, x in enumerate(body[i+1:i+8]):
+            data.append(x | (((msbs >> j) & 1) << 7))
+    return bytes(data)
+
+
+class Decoder:
+    """Byte stream to frames, resyncs on the next sync or sysex start"""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data):
+        self.buf += data
+        frames = []
+        while True:
+            start = self._next_start()
+            if start < 0:
+                # Keep a trailing partial sync byte
+                self.buf = self.buf[-1:] if self.buf[-1:] == SYNC[:1] else bytearray()
+                return frames
+            del self.buf[:start]
+
+            if self.buf[0] == 0xF0:
+                end = self.buf.find(b'\xf7')
+                if end < 0:
+                    return frames
+                message = bytes(self.buf[:end+1])
+                del self.buf[:end+1]
+                frame = self._sysex(message)
+            else:
+                if len(self.buf) < 4:
+                    return frames
+                length = self.buf[3]
+                if len(self.buf) < 6 + length:
+                    return frames
+                frame = self._binary(bytes(self.buf[:6+length]))
+                del self.buf[:2 if frame is None else 6+length]
+
+            if frame is not None:
+                frames.append(frame)
+
+    def _next_start(self):
+        sync = self.buf.find(SYNC)
+        sysex = self.buf.find(b'\xf0')
+        starts = [x for x in (sync, sysex) if x >= 0]
+        return min(starts) if starts else -1
+
+    def _binary(self, packet):
+        version, length = packet[2], packet[3]
+        body = packet[4:4+length]
+        if version != VERSION or length != FRAME_BYTES:
+            return None
+        if fletcher16(body) != (packet[4+length], packet[5+length]):
+            return None
+        return unpack_frame(body)
+
+    def _sysex(self, message):
+        # F0 7D 02 05 <chunk lsb> <chunk msb> <data ...> <checksum> F7
+        if len(message) < 8 or message[1] != SYSEX_ID or message[2] != SYSEX_DATA:
+            return None
+        if message[3] != SYSEX_TARGET_TELEMETRY:
+            return None
+        packed = message[6:-1]
+        if sum(packed) & 0x7F:
+            return None
+        data = unpack_sysex(packed[:-1])
+        if len(data) != FRAME_BYTES:
+            return None
+        return unpack_frame(data)
+
+
+def open_source(name, baud):
+    if name == '-':
+        return sys.stdin.buffer
+    if name.startswith('/dev/') or name.upper().startswith('COM'):
+        import serial
+        return serial.Serial(name, baud, timeout=0.1)
+    return open(name, 'rb')
+
+
+def period_message(n):
+    return bytes([0xF0, SYSEX_ID, SYSEX_SET_TELEMETRY, n & 0x7F, 0xF7])
+
+
+def show(frame):
+    print('%6d %9.1fs  voices %3d+%-3d  isr %5.1f%%  writes/s %7d  fifo %3d  '
+          'dropped %d stolen %d errors %d overruns %d  tempo %6.2f  '
+          'arp %d jitter %d/%d ns  boot %.2f/%.2f ms  state %d  merged %d' % (
+              frame['sequence'], frame['uptime_ms'] / 1000.0,
+              frame['voices_active'], frame['voices_releasing'],
+              100.0 * frame['isr_load'], frame['axi_writes_per_sec'],
+              frame['uart_fifo_irq_peak'], frame['notes_dropped'],
+              frame['notes_stolen'], frame['parser_errors'],
+              frame['uart_overruns'], frame['tempo_mbpm'] / 1000.0,
+              frame['arp_steps'], frame['arp_jitter_mean_ns'],
+              frame['arp_jitter_max_ns'], frame['boot_ready_us'] / 1000.0,
+              frame['boot_first_note_us'] / 1000.0, frame['last_state'],
+              frame['controls_merged']))
+    sys.stdout.flush()
+
+
+class Plot:
+    TRACES = [('voices', lambda f: f['voices_active'] + f['voices_releasing']),
+              ('isr load %', lambda f: 100.0 * f['isr_load']),
+              ('axi writes/s', lambda f: f['axi_writes_per_sec']),
+              ('uart fifo irq peak', lambda f: f['uart_fifo_irq_peak'])]
+
+    def __init__(self, depth=600):
+        import matplotlib.pyplot as plt
+        self.plt = plt
+        self.depth = depth
+        self.time = []
+        self.values = [[] for _ in self.TRACES]
+        self.fig, self.axes = plt.subplots(len(self.TRACES), 1, sharex=True)
+        self.lines = []
+        for ax, (name, _) in zip(self.axes, self.TRACES):
+            ax.set_ylabel(name)
+            self.lines.append(ax.plot([], [])[0])
+        self.axes[-1].set_xlabel('uptime (s)')
+        plt.ion()
+        plt.show()
+
+    def add(self, frame):
+        self.time = (self.time + [frame['uptime_ms'] / 1000.0])[-self.depth:]
+        for i, (_, value) in enumerate(self.TRACES):
+            self.values[i] = (self.values[i] + [value(frame)])[-self.depth:]
+            self.lines[i].set_data(self.time, self.values[i])
+            self.axes[i].relim()
+            self.axes[i].autoscale_view()
+        self.plt.pause(0.001)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode the synth telemetry')
+    parser.add_argument('source', nargs='?')
+    parser.add_argument('-b', '--baud', type=int, default=115200)
+    parser.add_argument('--csv')
+    parser.add_argument('--plot', action='store_true')
+    parser.add_argument('--period', type=int)
+    args = parser.parse_args()
+
+    if args.period is not None:
+        print(period_message(args.period).hex(' '))
+        return 0
+    if args.source is None:
+        parser.error('a source is needed')
+
+    source = open_source(args.source, args.baud)
+    csv = open(args.csv, 'w') if args.csv else None
+    if csv:
+        csv.write(','.join(FIELDS) + '\n')
+    plot = Plot() if args.plot else None
+
+    decoder = Decoder()
+    while True:
+        data = source.read(256) if hasattr(source, 'in_waiting') else source.read1(256)
+        if not data:
+            if hasattr(source, 'in_waiting'):
+                continue
+            break
+        for frame in decoder.feed(data):
+            show(frame)
+            if csv:
+                csv.write(','.join(str(frame[x]) for x in FIELDS) + '\n')
+            if plot:
+                plot.add(frame)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())